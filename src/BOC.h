@@ -45,6 +45,10 @@ namespace BOC{
 
 		Params *pParam;
 
+		//placement of the loader thread, -1 if not specified
+		int loader_cpu;
+		int loader_node;
+
 	public:
 		LibBOC(){
 			this->pLossFunc = NULL;
@@ -53,6 +57,8 @@ namespace BOC{
 			this->pOnlineModel = NULL;
 			this->pOpti = NULL;
 			this->pParam = NULL;
+			this->loader_cpu = -1;
+			this->loader_node = -1;
 			ModelInfo<FeatType, LabelType>::GetModelInfo(modelInfo);
 			LossInfo<FeatType, LabelType>::GetLossInfo(lossInfo);
 			IOInfo<FeatType, LabelType>::GetIOInfo(ioInfo);
@@ -111,6 +117,12 @@ namespace BOC{
 	protected:
 		inline int InitLoss(Params &param){
 			string loss_type = param.StringValue("-loss");
+			//loss function given with the first model in a list, like "DAROW:SquaredHinge,STG"
+			string model = param.StringValue("-m");
+			model = model.substr(0, model.find(','));
+			if (model.find(':') != string::npos){
+				loss_type = model.substr(model.find(':') + 1);
+			}
 			this->pLossFunc = (LossFunction<FeatType, LabelType>*)
 				Registry::CreateObject(loss_type);
 			if (this->pLossFunc == NULL) {
@@ -120,7 +132,70 @@ namespace BOC{
 			return STATUS_OK;
 		}
 
+		/**
+		 * @Synopsis InitPlacement bind the learner (the calling thread) and the
+		 * loader to processors, and allocate memory on the numa node of the learner
+		 * if required. Called before any allocation of data and models.
+		 */
+		inline int InitPlacement(Params &param){
+			int cpu_num = get_cpu_num();
+			int learner_cpu = param.IntValue("-cpu_learner");
+			this->loader_cpu = param.IntValue("-cpu_loader");
+			if (learner_cpu >= cpu_num || this->loader_cpu >= cpu_num){
+				fprintf(stderr, "Error %d: processor index should be smaller than %d\n", STATUS_INVALID_ARGUMENT, cpu_num);
+				return STATUS_INVALID_ARGUMENT;
+			}
+			if (learner_cpu >= 0 && bind_current_thread(learner_cpu) == false){
+				fprintf(stderr, "Warning: bind learner to cpu %d failed\n", learner_cpu);
+			}
+
+			int learner_node = get_cpu_node(learner_cpu >= 0 ? learner_cpu : get_current_cpu());
+			this->loader_node = -1;
+			if (param.BoolValue("-numa_local") == true){
+				if (learner_node < 0 || set_preferred_node(learner_node) == false){
+					fprintf(stderr, "Warning: numa local allocation is not available\n");
+				}
+				else{
+					this->loader_node = learner_node;
+					//keep an unbound learner on the node of its memory
+					if (learner_cpu < 0 && bind_current_thread_to_node(learner_node) == false){
+						fprintf(stderr, "Warning: bind learner to node %d failed\n", learner_node);
+					}
+				}
+			}
+
+			//the report goes to stderr, as stdout carries the predictions of -serve stdin
+			if (learner_cpu >= 0 || this->loader_cpu >= 0 || this->loader_node >= 0){
+				fprintf(stderr, "Thread placement:\n");
+				if (learner_cpu >= 0){
+					fprintf(stderr, "\tlearner: cpu %d, node %d\n", learner_cpu, learner_node);
+				}
+				else if (this->loader_node >= 0){
+					fprintf(stderr, "\tlearner: cpus of node %d\n", learner_node);
+				}
+				else{
+					fprintf(stderr, "\tlearner: not bound\n");
+				}
+				if (this->loader_cpu >= 0){
+					fprintf(stderr, "\tloader : cpu %d, node %d\n", this->loader_cpu, get_cpu_node(this->loader_cpu));
+				}
+				else{
+					fprintf(stderr, "\tloader : not bound\n");
+				}
+				if (this->loader_node >= 0){
+					fprintf(stderr, "\tmemory : node %d\n", this->loader_node);
+				}
+			}
+			return STATUS_OK;
+		}
+
 		inline int InitDataSet(Params &param){
+			int dense_dim = param.IntValue("-dense_dim");
+			int promote_count = param.IntValue("-promote");
+			if (dense_dim < 0 || promote_count < 1){
+				fprintf(stderr, "Error %d: dense_dim must be no less than 0 and promote must be larger than 0\n", STATUS_INVALID_ARGUMENT);
+				return STATUS_INVALID_ARGUMENT;
+			}
 			string drt_type = param.StringValue("-drt");
 			ToLowerCase(drt_type);
 			if (drt_type == "online"){
@@ -128,6 +203,7 @@ namespace BOC{
 				int chunk_size = param.IntValue("-cs");
 				this->pDataset = new OnlineDataSet<FeatType, LabelType>(param.IntValue("-passes"),
 					param.BoolValue("-norm"), buf_size, chunk_size);
+				((OnlineDataSet<FeatType, LabelType>*)this->pDataset)->SetLoaderPlacement(this->loader_cpu, this->loader_node);
 
 				if (this->pDataset == NULL){
 					fprintf(stderr, "Error %d: init dataset failed! (%s)\n", STATUS_INIT_FAIL, drt_type.c_str());
@@ -143,6 +219,8 @@ namespace BOC{
 					fprintf(stderr, "%s\n", ex.what());
 					return STATUS_INVALID_ARGUMENT;
 				}
+				//the map of the training data is used by the test data and the models
+				this->pDataset->GetFeatureMap().config(dense_dim, promote_count);
 			}
 			else if (drt_type == "batch"){
 				fprintf(stderr, "Error %d: batch dataset is not supported yet\n", STATUS_INVALID_ARGUMENT);
@@ -158,8 +236,31 @@ namespace BOC{
 		}
 
 		inline int InitModel(Params &param){
-			//check model type
+			const string& kernel_name = param.StringValue("-simd");
+			if (set_sparse_kernel(kernel_name) == false){
+				fprintf(stderr, "Error %d: sparse kernel %s is not supported\n", STATUS_INVALID_ARGUMENT, kernel_name.c_str());
+				return STATUS_INVALID_ARGUMENT;
+			}
+
+			//the models of opt_multi and opt_halving are created by the optimizer
+			//for each setting, no primary model is needed
+			const string optType = this->GetOptimizerType(param);
+			if (optType == "opt_multi" || optType == "opt_halving"){
+				if (param.StringValue("-im").length() > 0){
+					fprintf(stderr, "Error %d: -im can not be used with %s\n", STATUS_INVALID_ARGUMENT, optType.c_str());
+					return STATUS_INVALID_ARGUMENT;
+				}
+				if (param.StringValue("-i").length() == 0 && param.StringValue("-c").length() == 0){
+					fprintf(stderr, "Error %d: %s trains the models, -i or -c is required\n", STATUS_INVALID_ARGUMENT, optType.c_str());
+					return STATUS_INVALID_ARGUMENT;
+				}
+				return STATUS_OK;
+			}
+
+			//check model type, the first one is used if a list of models is given
 			string model = param.StringValue("-m");
+			model = model.substr(0, model.find(','));
+			model = model.substr(0, model.find(':'));
 			try{
 				this->pModel = (LearnModel<FeatType, LabelType>*)Registry::CreateObject(model, this->pLossFunc, (void*)(param.IntValue("-cn")));
 			}
@@ -189,6 +290,7 @@ namespace BOC{
 			}
 
 			//load existing model
+			this->pModel->SetFeatureMap(&this->pDataset->GetFeatureMap());
 			const string& input_model_file = param.StringValue("-im");
 			if (input_model_file.length() > 0){
 				if (this->pModel->LoadModel(input_model_file) == false){
@@ -207,9 +309,21 @@ namespace BOC{
 			return STATUS_OK;
 		}
 
-		inline int InitOptimizer(Params &param){
+		//type of the optimizer, opt_multi if the default one is given with a
+		//list of models or cross validation
+		inline string GetOptimizerType(Params &param) const {
 			string optType = param.StringValue("-opt");
 			ToLowerCase(optType);
+			//cross validation is done by training the fold models side by side
+			if (optType == init_opt_type && (param.IntValue("-cv") > 1 ||
+				param.StringValue("-m").find(',') != string::npos)){
+				optType = "opt_multi";
+			}
+			return optType;
+		}
+
+		inline int InitOptimizer(Params &param){
+			const string optType = this->GetOptimizerType(param);
 			this->pOpti = (Optimizer<FeatType, LabelType>*)
 				Registry::CreateObject(optType, this->pOnlineModel, this->pDataset);
 
@@ -218,8 +332,43 @@ namespace BOC{
 				return STATUS_INIT_FAIL;
 			}
 
+			//the state of the other optimizers and of the hashed features is not saved
+			if (param.StringValue("-ckpt").length() > 0 || param.StringValue("-resume").length() > 0){
+				if (optType != init_opt_type){
+					fprintf(stderr, "Error %d: checkpoints are only supported by %s\n", STATUS_INVALID_ARGUMENT, init_opt_type);
+					return STATUS_INVALID_ARGUMENT;
+				}
+				if (this->pDataset->GetFeatureMap().enabled() == true){
+					fprintf(stderr, "Error %d: checkpoints can not be used with dense_dim\n", STATUS_INVALID_ARGUMENT);
+					return STATUS_INVALID_ARGUMENT;
+				}
+				//the chunks of the multipass buffer are read as soon as no parsed
+				//chunk is ready, so the order of the examples is not repeatable
+				if (param.StringValue("-mbt") != init_mp_buf_type){
+					fprintf(stderr, "Error %d: checkpoints can not be used with the multipass buffer (-mbt)\n", STATUS_INVALID_ARGUMENT);
+					return STATUS_INVALID_ARGUMENT;
+				}
+			}
+
+			if (param.StringValue("-metrics_out").length() > 0 && optType != init_opt_type){
+				fprintf(stderr, "Error %d: -metrics_out is only supported by %s\n", STATUS_INVALID_ARGUMENT, init_opt_type);
+				return STATUS_INVALID_ARGUMENT;
+			}
+
+			try{
+				this->pOpti->SetParameter(param);
+			}
+			catch (invalid_argument &ex){
+				fprintf(stderr, "%s\n", ex.what());
+				return STATUS_INVALID_ARGUMENT;
+			}
+
 			const string& pre_sel_feat_file = param.StringValue("-pf");
 			if (pre_sel_feat_file.length() > 0){
+				if (this->pDataset->GetFeatureMap().enabled() == true){
+					fprintf(stderr, "Error %d: pre-selected features can not be used with dense_dim\n", STATUS_INVALID_ARGUMENT);
+					return STATUS_INVALID_ARGUMENT;
+				}
 				return this->pOpti->LoadPreSelFeatures(pre_sel_feat_file);
 			}
 			return STATUS_OK;
@@ -230,7 +379,10 @@ namespace BOC{
 			this->Release();
 
 			int errCode = STATUS_OK;
-			errCode = this->InitDataSet(param);
+			errCode = this->InitPlacement(param);
+			if (errCode == STATUS_OK){
+				errCode = this->InitDataSet(param);
+			}
 			if (errCode == STATUS_OK){
 				errCode = this->InitLoss(param);
 			}
@@ -264,6 +416,20 @@ namespace BOC{
 			printf("\nData number: %lu\n", this->pDataset->size());
 			printf("Training error rate: %.2f %%\n", l_errRate * 100);
 			printf("Training time: %.3f s\n", (float)(time2 - time1));
+			const feature_map &map = this->pDataset->GetFeatureMap();
+			if (map.enabled() == true){
+				printf("Hashed features: %lu (%lu with weights)\n", map.tail_num(), map.promoted_num());
+				if (map.dropped_num() > 0){
+					printf("Dropped occurrences of hashed features: %lu\n", map.dropped_num());
+				}
+			}
+			PipelineStats pipeline_stats;
+			if (this->pDataset->GetPipelineStats(pipeline_stats) == true){
+				pipeline_stats.Print();
+			}
+			if (this->pOpti->GetTrainMetrics().empty() == false){
+				this->pOpti->GetTrainMetrics().Print("Training");
+			}
 			return STATUS_OK;
 		}
 
@@ -273,6 +439,8 @@ namespace BOC{
 			//test the model
 			OnlineDataSet<FeatType, LabelType> testset(1, this->pParam->BoolValue("-norm"),
 				this->pParam->IntValue("-bs"), this->pParam->IntValue("-cs"));
+			testset.SetLoaderPlacement(this->loader_cpu, this->loader_node);
+			testset.SetTrainFeatureMap(&this->pDataset->GetFeatureMap());
 			if (testset.Load(this->pParam->StringValue("-t"),
 				this->pParam->StringValue("-tc"),
 				this->pParam->StringValue("-df")) == true) {
@@ -298,6 +466,9 @@ namespace BOC{
 
 				printf("Test error rate: %.2f %%\n", t_errRate * 100);
 				printf("Test time: %.3f s\n", (float)(time3 - time2));
+				if (this->pOpti->GetTestMetrics().empty() == false){
+					this->pOpti->GetTestMetrics().Print("Test");
+				}
 			}
 			else{
 				fprintf(stderr, "load test set failed!\n");
@@ -306,20 +477,51 @@ namespace BOC{
 			return STATUS_OK;
 		}
 
-		int Run(){
-			this->pModel->PrintModelSettings();
+		/**
+		 * @Synopsis Serve serve the predictions of the loaded model until the
+		 * input ends or the process is stopped
+		 */
+		int Serve() {
+			PredictServer<FeatType, LabelType> server(this->pModel);
+			try{
+				server.SetParameter(this->pParam->IntValue("-threads"), this->pParam->IntValue("-serve_batch"),
+					this->pParam->IntValue("-serve_wait"), this->pParam->BoolValue("-norm"));
+			}
+			catch (invalid_argument &ex){
+				fprintf(stderr, "%s\n", ex.what());
+				return STATUS_INVALID_ARGUMENT;
+			}
+			server.SetFeatureMap(&this->pDataset->GetFeatureMap());
+			this->pModel->Freeze();
+			return server.Serve(this->pParam->StringValue("-serve"));
+		}
 
+		int Run(){
 			int ret = STATUS_OK;
-			//train
 			bool is_train = this->pParam->StringValue("-i").length() > 0 || 
 				this->pParam->StringValue("-c").length() > 0;
+			//stdout may be the output of the predictions, nothing else is printed
+			if (this->pParam->StringValue("-serve").length() > 0){
+				if (is_train == true || this->pParam->StringValue("-im").length() == 0){
+					fprintf(stderr, "Error %d: -serve serves a model loaded by -im, without training\n", STATUS_INVALID_ARGUMENT);
+					return STATUS_INVALID_ARGUMENT;
+				}
+				return this->Serve();
+			}
+
+			if (this->pModel != NULL){
+				this->pModel->PrintModelSettings();
+			}
+
+			//train
 			if (ret == STATUS_OK && is_train) {
 				ret = Train();
 			}
 
-			this->pModel->PrintModelInfo();
+			LearnModel<FeatType, LabelType>* pTrainedModel = this->pOpti->GetModel();
+			pTrainedModel->PrintModelInfo();
 			if (this->pParam->StringValue("-om").length() > 0){
-				this->pModel->SaveModel(this->pParam->StringValue("-om"));
+				this->pOpti->SaveModel(this->pParam->StringValue("-om"));
 			}
 			//test
 			bool is_test = this->pParam->StringValue("-tc").length() > 0 ||
@@ -352,24 +554,44 @@ namespace BOC{
 				param.add_option(init_buf_size, 0, 1, "Buffer Size: number of chunks for buffering", "-bs", "Input Output");
 				param.add_option(init_chunk_size, 0, 1, "Chunk Size: number of examples in a chunk", "-cs", "Input Output");
 				param.add_option(init_normalize, 0, 0, "whether normalize the data", "-norm", "Input Output");
+				param.add_option(-1, 0, 1, "processor to bind the data loader to", "-cpu_loader", "Input Output");
+				param.add_option(-1, 0, 1, "processor to bind the learner to", "-cpu_learner", "Input Output");
+				param.add_option(false, 0, 0, "allocate data and models on the numa node of the learner, and keep an unbound learner on that node", "-numa_local", "Input Output");
 
 				//Training Settings
 				param.add_option("", false, 1, "input existing model", "-im", "Training Settings");
-				param.add_option("", false, 1, "output readable model", "-om", "Training Settings");
+				param.add_option("", false, 1, "output model", "-om", "Training Settings");
+				param.add_option(init_model_format, 0, 1, "format of the output model (binary, text)", "-mf", "Training Settings");
+				param.add_option("", 0, 1, "serve the predictions of the input model to stdin or a unix domain socket (stdin, or the socket path)", "-serve", "Training Settings");
+				param.add_option(init_serve_batch, 0, 1, "maximum number of examples scored together in serving", "-serve_batch", "Training Settings");
+				param.add_option(init_serve_wait, 0, 1, "milliseconds an example waits for others to be scored together", "-serve_wait", "Training Settings");
+				param.add_option("", 0, 1, "path of the checkpoints with the complete training state, written in the background", "-ckpt", "Training Settings");
+				param.add_option(init_ckpt_every, 0, 1, "number of examples between two checkpoints (0 to disable)", "-ckpt_every", "Training Settings");
+				param.add_option(init_ckpt_secs, 0, 1, "seconds between two checkpoints (0 to disable)", "-ckpt_secs", "Training Settings");
+				param.add_option("", 0, 1, "resume training from a checkpoint", "-resume", "Training Settings");
+				param.add_option("", 0, 1, "output of the progress and throughput records, one json object in a line", "-metrics_out", "Training Settings");
+				param.add_option(init_metrics_every, 0, 1, "number of examples between two progress records (0 to disable)", "-metrics_every", "Training Settings");
+				param.add_option(init_metrics_secs, 0, 1, "seconds between two progress records (0 to disable)", "-metrics_secs", "Training Settings");
 				param.add_option(1, 0, 1, "number of passes", "-passes", "Training Settings");
 				param.add_option(init_mp_buf_type, 0, 1, "Multipass Buffer Type", "-mbt", "Training Settings");
 				param.add_option(init_mp_buf_size, 0, 1, "Multipass Buffer Size", "-mbs", "Training Settings");
+				param.add_option(init_sparse_kernel, 0, 1, "sparse kernel (auto, scalar, avx2, avx512)", "-simd", "Training Settings");
+				param.add_option(init_state_layout, 0, 1, "layout of per-feature model states (aos, soa)", "-layout", "Training Settings");
+				param.add_option(init_state_precision, 0, 1, "precision of per-feature model states (fp32, bf16)", "-precision", "Training Settings");
+				param.add_option(init_dense_dim, 0, 1, "feature indexes below are stored densely, larger ones are hashed (0 to disable)", "-dense_dim", "Training Settings");
+				param.add_option(init_promote_count, 0, 1, "occurrences before a hashed feature gets a weight, the features seen fewer times are dropped (1 to keep all)", "-promote", "Training Settings");
 
 				//loss function
 				param.add_option(init_loss_type, 0, 1, "loss function type", "-loss", "Loss Functions");
 
 				//model setting
 				param.add_option(2, 0, 1, "class number:", "-cn", "Model Settings");
-				param.add_option(init_algo_method, 0, 1, "learning model:", "-m", "Model Settings");
+				param.add_option(init_algo_method, 0, 1, "learning model, or a list like \"STG,DAROW:SquaredHinge\" to train side by side:", "-m", "Model Settings");
 				param.add_option(-1.f, 0, 1, "learning rate", "-eta", "Model Settings");
 				param.add_option(-1.f, 0, 1, "power t of decaying learning rate", "-power_t", "Model Settings");
 				param.add_option(-1, 0, 1, "initial iteration number", "-t0", "Model Settings");
 				param.add_option(-1.f, 0, 1, "l1 regularization", "-l1", "Model Settings");
+				param.add_option(-1.f, 0, 1, "l2 regularization (SGD)", "-l2", "Model Settings");
 				param.add_option(-1, 0, 1,
 					"number of k in truncated gradient descent or feature selection", "-k", "Model Settings");
 				param.add_option(-1.f, 0, 1, "gamma times rou in enhanced RDA (RDA_E)", "-grou", "Model Settings");
@@ -379,6 +601,13 @@ namespace BOC{
 				//optimizer
 				param.add_option(init_opt_type, 0, 1, "optimization algorithm", "-opt", "Optimizer");
 				param.add_option("", false, 1, "pre-selected features", "-pf", "Optimizer");
+				param.add_option(init_batch_size, 0, 1, "number of examples in a mini-batch", "-batch", "Optimizer");
+				param.add_option(false, 0, 0, "use the virtual training loop even if a specialized one exists", "-dynamic", "Optimizer");
+				param.add_option("", 0, 1, "parameter grid for opt_multi, e.g. \"eta=1,2;l1=1e-4,1e-3\"", "-grid", "Optimizer");
+				param.add_option(init_thread_num, 0, 1, "number of training threads, 0 for the number of processors", "-threads", "Optimizer");
+				param.add_option(0, 0, 1, "number of folds in cross validation", "-cv", "Optimizer");
+				param.add_option(false, 0, 0, "compute AUC, log loss, precision, recall and the confusion matrix in training and test", "-eval", "Optimizer");
+				param.add_option(init_halving_budget, 0, 1, "number of examples of the first rung in opt_halving", "-budget", "Optimizer");
 			}
 	};
 
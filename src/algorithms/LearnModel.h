@@ -13,6 +13,7 @@
 #include "../utils/util.h"
 #include "../utils/reflector.h"
 #include "../utils/Params.h"
+#include "../utils/feature_map.h"
 #include "../io/DataPoint.h"
 
 #include <stdexcept>
@@ -58,12 +59,14 @@ namespace BOC {
 
 	protected:
 		LossFunction<FeatType, LabelType> *lossFunc;
+		//map of the feature indexes to the weight slots, NULL if not mapped
+		feature_map *featMap;
 #pragma endregion Class Members
 
 #pragma region Constructors and Basic Functions
 	public:
 		LearnModel(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
-			lossFunc(lossFunc), class_num(classNum){
+			lossFunc(lossFunc), featMap(NULL), class_num(classNum){
 			this->classfier_num = this->class_num == 2 ? 1 : this->class_num;
 			INVALID_ARGUMENT_EXCEPTION(class_num, class_num > 1, "no smaller than 2");
 
@@ -108,6 +111,22 @@ namespace BOC {
 		*/
 		int GetClassfierNum() const { return this->classfier_num; }
 
+		/**
+		*  GetLossFunction Get the loss function of the model
+		*/
+		const LossFunction<FeatType, LabelType>* GetLossFunction() const { return this->lossFunc; }
+
+		/**
+		 * @Synopsis SetFeatureMap set the map of the data the model is trained
+		 * on, so that the original feature indexes are saved and loaded
+		 */
+		void SetFeatureMap(feature_map *map) { this->featMap = map; }
+
+		//whether the features are mapped to the weight slots
+		inline bool IsFeatureMapped() const {
+			return this->featMap != NULL && this->featMap->enabled();
+		}
+
 #pragma endregion Constructors and Basic Functions
 
 #pragma region IO related
@@ -138,7 +157,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelConfig(std::ofstream &os) = 0;
+		virtual bool SaveModelConfig(std::ostream &os) = 0;
 
 		/**
 		 * @Synopsis LoadModelConfig load configuration of model from disk
@@ -147,7 +166,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelConfig(std::ifstream &is) = 0;
+		virtual bool LoadModelConfig(std::istream &is) = 0;
 
 		/**
 		 * @Synopsis  SaveModelValue save model value to disk
@@ -156,7 +175,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelValue(std::ofstream &os) = 0;
+		virtual bool SaveModelValue(std::ostream &os) = 0;
 
 		/**
 		 * @Synopsis LoadModelConfig load values of model from disk
@@ -165,7 +184,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelValue(std::ifstream &is) = 0;
+		virtual bool LoadModelValue(std::istream &is) = 0;
 #pragma endregion IO related
 
 #pragma region Common Functions for Train and Test
@@ -227,6 +246,13 @@ namespace BOC {
 
 #pragma region Test related
 	public:
+		/**
+		 * @Synopsis Freeze prepare the trained model for prediction, called
+		 * before a test, nothing is done by default
+		 */
+		virtual void Freeze() {
+		}
+
 		/**
 		 * @Synopsis Predict prediction function for test
 		 *
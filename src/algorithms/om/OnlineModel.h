@@ -8,14 +8,68 @@
 #define HEADER_ONLINE_MODEL
 
 #include "../LearnModel.h"
+#include "../../io/DataChunk.h"
 #include "../../utils/util.h"
+#include "../../utils/eval_metrics.h"
 
 #include <vector>
+#include <utility>
 
 /**
 *  namespace: Batch and Online Classification
 */
 namespace BOC {
+	/**
+	 * @Synopsis statistics of online training, updated in the same pass as the
+	 * iterations
+	 */
+	struct IterateStat {
+		//number of mistakes
+		size_t errorNum;
+		//number of processed examples
+		size_t dataNum;
+		//progress is recorded when dataNum reaches show_count
+		size_t show_count;
+		int show_step;
+		//recorded (dataNum, errorNum) pairs to be shown
+		std::vector<std::pair<size_t, size_t> > progress;
+		//metrics of the predictions before the updates, NULL if not evaluated
+		eval_metrics* metrics;
+
+		IterateStat() : errorNum(0), dataNum(0), show_count(2), show_step(1), metrics(NULL) {
+		}
+
+		/**
+		 * @Synopsis Add count the result of an example, the margin of a mistaken
+		 * example is recorded in the example
+		 *
+		 * @Param data the example
+		 * @Param predict predicted values of the example
+		 * @Param predictLabel predicted class of the example
+		 * @Param classifierNum number of classifiers
+		 */
+		template <typename FeatType, typename LabelType>
+		inline void Add(DataPoint<FeatType, LabelType> &data, const float* predict,
+			int predictLabel, int classifierNum) {
+			if (predictLabel != data.label){
+				this->errorNum++;
+				if (classifierNum == 1){
+					data.margin = *predict * data.label;
+				}
+				else{
+					data.margin = predict[predictLabel];
+				}
+			}
+			if (this->metrics != NULL){
+				this->metrics->Add(data.label, predict, predictLabel);
+			}
+			this->dataNum++;
+			if (this->dataNum == this->show_count){
+				this->progress.push_back(std::make_pair(this->dataNum, this->errorNum));
+				this->show_count = (size_t(1) << ++this->show_step);
+			}
+		}
+	};
 
 	template <typename FeatType, typename LabelType>
 	class OnlineModel : public LearnModel < FeatType, LabelType > {
@@ -89,6 +143,44 @@ namespace BOC {
 		 */
 		virtual void EndTrain(){}
 
+		/**
+		 * @Synopsis SaveCheckpoint save the model and the complete state of
+		 * the optimization during training, so that training can be resumed
+		 *
+		 * @Param filename path of the checkpoint
+		 * @Param progress state of the optimizer, saved as it is
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveCheckpoint(const string &filename, const string &progress) {
+			fprintf(stderr, "checkpoints are not supported by %s\n", this->modelName.c_str());
+			return false;
+		}
+
+		/**
+		 * @Synopsis LoadCheckpoint load the checkpoint saved by SaveCheckpoint,
+		 * called after BeginTrain
+		 *
+		 * @Param filename path of the checkpoint
+		 * @Param progress state of the optimizer
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadCheckpoint(const string &filename, string &progress) {
+			fprintf(stderr, "checkpoints are not supported by %s\n", this->modelName.c_str());
+			return false;
+		}
+
+		/**
+		 * @Synopsis GetLearningRate current learning rate
+		 */
+		inline float GetLearningRate() const { return this->eta; }
+
+		/**
+		 * @Synopsis GetNonZeroNum get the number of nonzero weights
+		 */
+		virtual IndexType GetNonZeroNum() const = 0;
+
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -134,6 +226,60 @@ namespace BOC {
 		 */
 		virtual int IterateMC(const DataPoint<FeatType, LabelType> &x, float* predict) = 0;
 
+		/**
+		 * @Synopsis IterateChunk Iteration of online learning on all the examples of
+		 * a chunk. The model dimension is updated once with the max index of the
+		 * chunk, mistakes and margins are counted in the same pass.
+		 *
+		 * @Param chunk examples to iterate
+		 * @Param predict buffer of the predicted values, classifier number
+		 * @Param stat training statistics
+		 */
+		virtual void IterateChunk(DataChunk<DataPoint<FeatType, LabelType> > &chunk, float* predict,
+			IterateStat &stat){
+			this->UpdateModelDimention(chunk.max_index);
+			if (this->classfier_num == 1){
+				for (size_t j = 0; j < chunk.dataNum; ++j){
+					DataPoint<FeatType, LabelType> &data = chunk.data[j];
+					stat.Add(data, predict, this->IterateBC(data, predict), 1);
+				}
+			}
+			else{
+				for (size_t j = 0; j < chunk.dataNum; ++j){
+					DataPoint<FeatType, LabelType> &data = chunk.data[j];
+					stat.Add(data, predict, this->IterateMC(data, predict), this->classfier_num);
+				}
+			}
+		}
+
+		/**
+		 * @Synopsis IsBatchSupported whether the model can apply the gradients of a
+		 * mini-batch in one combined update
+		 */
+		virtual bool IsBatchSupported() const { return false; }
+
+		/**
+		 * @Synopsis IterateBatch Iteration of online learning on a mini-batch, the
+		 * default implementation iterates the examples one by one
+		 *
+		 * @Param data the first example of the mini-batch
+		 * @Param num number of examples in the mini-batch
+		 * @Param predicts predicted values of each example, num * classifier number
+		 * @Param predictLabels predicted class of each example
+		 */
+		virtual void IterateBatch(const DataPoint<FeatType, LabelType> *data, size_t num,
+			float* predicts, int* predictLabels){
+			for (size_t j = 0; j < num; ++j){
+				float* predict = predicts + j * this->classfier_num;
+				if (this->classfier_num == 1){
+					predictLabels[j] = this->IterateBC(data[j], predict);
+				}
+				else{
+					predictLabels[j] = this->IterateMC(data[j], predict);
+				}
+			}
+		}
+
 #pragma endregion Train Related
 	};
 
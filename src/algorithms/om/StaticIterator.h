@@ -0,0 +1,113 @@
+/*************************************************************************
+	> File Name: StaticIterator.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 8:03:26 PM
+	> Functions: training loops specialized for (model, loss) pairs
+	************************************************************************/
+#ifndef HEADER_STATIC_ITERATOR
+#define HEADER_STATIC_ITERATOR
+
+#include "OnlineModel.h"
+
+#include <typeinfo>
+#include <string>
+
+/**
+*  namespace: Batch and Online Classification
+*/
+namespace BOC {
+	/**
+	 * @Synopsis interface of training loops iterating a range of examples
+	 */
+	template <typename FeatType, typename LabelType>
+	class OnlineIterator : public Registry {
+	public:
+		virtual ~OnlineIterator() {
+		}
+
+		/**
+		 * @Synopsis IterateChunk iterate the examples of a chunk, the same as
+		 * OnlineModel::IterateChunk
+		 *
+		 * @Param chunk examples to iterate
+		 * @Param predict buffer of the predicted values, classifier number
+		 * @Param stat training statistics
+		 */
+		virtual void IterateChunk(DataChunk<DataPoint<FeatType, LabelType> > &chunk, float* predict,
+			IterateStat &stat) = 0;
+
+		/**
+		 * @Synopsis GetIteratorName name of the specialized loop of a model and a loss
+		 * function, like "SGD+Hinge"
+		 */
+		static std::string GetIteratorName(const OnlineModel<FeatType, LabelType> *model) {
+			return model->GetType() + "+" + model->GetLossFunction()->GetType();
+		}
+	};
+
+	/**
+	 * @Synopsis training loop with the model and the loss known at compile
+	 * time, so that no virtual function is called per example. ModelType must
+	 * provide the template function IterateBCStatic<LossType>.
+	 */
+	template <typename FeatType, typename LabelType, typename ModelType, typename LossType>
+	class StaticIterator : public OnlineIterator < FeatType, LabelType > {
+	protected:
+		ModelType *model;
+
+	public:
+		StaticIterator(ModelType *model) : model(model) {
+		}
+
+		virtual void IterateChunk(DataChunk<DataPoint<FeatType, LabelType> > &chunk, float* predict,
+			IterateStat &stat) {
+			ModelType *model = this->model;
+			model->UpdateModelDimention(chunk.max_index);
+			for (size_t j = 0; j < chunk.dataNum; ++j){
+				if (j + 1 < chunk.dataNum){
+					model->ModelType::PrefetchWeights(chunk.data[j + 1]);
+				}
+				DataPoint<FeatType, LabelType> &data = chunk.data[j];
+				stat.Add(data, predict, model->template IterateBCStatic<LossType>(data, predict), 1);
+			}
+		}
+
+		/**
+		 * @Synopsis IsMatched whether the model and its loss are exactly the
+		 * specialized types, sub-classes may override the virtual functions
+		 */
+		static bool IsMatched(const OnlineModel<FeatType, LabelType> *model) {
+			return model != NULL && model->GetLossFunction() != NULL &&
+				typeid(*model) == typeid(ModelType) &&
+				typeid(*model->GetLossFunction()) == typeid(LossType) &&
+				model->GetClassfierNum() == 1;
+		}
+	};
+
+	//register the specialized training loop of a model and a loss function
+#define IMPLEMENT_STATIC_ITERATOR(modelName, lossClass, lossName) \
+	template <typename FeatType, typename LabelType> \
+	class modelName##_##lossName##_Iterator : public StaticIterator <FeatType, LabelType, \
+		modelName<FeatType, LabelType>, lossClass<FeatType, LabelType> > { \
+		DECLARE_CLASS \
+	public: \
+		modelName##_##lossName##_Iterator(modelName<FeatType, LabelType> *model) : \
+			StaticIterator<FeatType, LabelType, modelName<FeatType, LabelType>, \
+			lossClass<FeatType, LabelType> >(model) {} \
+	}; \
+	\
+	template <typename FeatType, typename LabelType> \
+	ClassInfo modelName##_##lossName##_Iterator<FeatType, LabelType>::classInfo(#modelName "+" #lossName, \
+		"specialized training loop", modelName##_##lossName##_Iterator<FeatType, LabelType>::CreateObject); \
+	\
+	template <typename FeatType, typename LabelType> \
+	void* modelName##_##lossName##_Iterator<FeatType, LabelType>::CreateObject(void *model, void* param2, void* param3) { \
+		if (StaticIterator<FeatType, LabelType, modelName<FeatType, LabelType>, \
+			lossClass<FeatType, LabelType> >::IsMatched((OnlineModel<FeatType, LabelType>*)model) == false) { \
+			return NULL; \
+		} \
+		return new modelName##_##lossName##_Iterator<FeatType, LabelType>((modelName<FeatType, LabelType>*)model); \
+	}
+}
+
+#endif
@@ -185,6 +185,38 @@ namespace BOC {
 				sigma_w[0] *= this->r / (this->r + sigma_w[0] * cw);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the variances of the weights to the
+		 * checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (OnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->sigmaWMatrix);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the variances of the weights from the
+		 * checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (OnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return reader.read_array(this->sigmaWMatrix);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(DAROW, "Diagonal AROW")
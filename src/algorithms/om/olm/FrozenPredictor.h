@@ -0,0 +1,223 @@
+/*************************************************************************
+	> File Name: FrozenPredictor.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 2:18:40 PM
+	> Functions: compact read-only copy of the weights of a linear model
+	> for prediction
+	************************************************************************/
+#ifndef HEADER_FROZEN_PREDICTOR
+#define HEADER_FROZEN_PREDICTOR
+
+#include "../../../io/DataPoint.h"
+#include "../../../utils/s_array.h"
+#include "../../../utils/config.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace BOC {
+	/**
+	 * The weights of all the classifiers are kept in rows, one per feature,
+	 * so that scoring a feature touches one cache line for any number of
+	 * classes. Row 0 is zero and is used for the features not in the model.
+	 *
+	 * If most weights are zero, like after feature selection or with l1
+	 * regularization, only the features with a nonzero weight have a row,
+	 * and are found by an open-addressing hash table. Otherwise the row of
+	 * feature i is i + 1, the lookup has no branch. Dense weights of binary
+	 * classification are not copied, as one weight is a row already.
+	 */
+	template <typename FeatType, typename LabelType>
+	class FrozenPredictor {
+	protected:
+		struct entry {
+			IndexType key; //feature index, EMPTY_KEY for empty entries
+			uint32_t row; //0 for empty entries
+		};
+		static const IndexType EMPTY_KEY = (IndexType)(-1);
+
+		int classfier_num;
+		//weights of the features, classfier_num in a row
+		s_array<float> rows;
+		s_array<float> bias;
+		//features are hashed, or indexes below dim have a row
+		bool is_hashed;
+		IndexType dim;
+		s_array<entry> table;
+		size_t mask;
+		//the slot of a feature is the top table_bits bits of its hash
+		int table_bits;
+		//number of features with a row
+		size_t feat_num;
+
+	public:
+		FrozenPredictor() : classfier_num(1), is_hashed(false), dim(0), mask(0), table_bits(0), feat_num(0) {
+		}
+
+		inline bool hashed() const { return this->is_hashed; }
+		inline size_t size() const { return this->feat_num; }
+		//bytes of memory of the weights and the table
+		inline size_t memory() const {
+			return this->rows.size() * sizeof(float) + this->table.size() * sizeof(entry);
+		}
+
+		/**
+		 * @Synopsis Compile copy the weights to the compact layout
+		 *
+		 * @Param weightMatrix weight vectors of the classifiers, the first
+		 * element is the bias
+		 * @Param scales scale factor of each weight vector
+		 * @Param weightDim dimension of the weight vectors
+		 *
+		 * @Returns false if the weights of binary classification are dense,
+		 * which are then better used as they are
+		 */
+		bool Compile(const std::vector<s_array<float> > &weightMatrix, const float* scales, IndexType weightDim) {
+			int K = (int)weightMatrix.size();
+			this->classfier_num = K;
+			this->bias.resize(K);
+			for (int k = 0; k < K; ++k){
+				this->bias[k] = weightMatrix[k][0] * scales[k];
+			}
+
+			//a hashed feature takes at least two entries and a row, stop
+			//counting once hashing is not smaller
+			size_t dense_bytes = ((size_t)weightDim + 1) * K * sizeof(float);
+			size_t feat_bytes = 2 * sizeof(entry) + K * sizeof(float);
+			size_t nonZeroNum = 0;
+			for (IndexType i = 0; i < weightDim && nonZeroNum * feat_bytes * 2 < dense_bytes; i += 4096){
+				IndexType end = std::min<IndexType>(i + 4096, weightDim);
+				if (K == 1){
+					const float* w = weightMatrix[0].begin;
+					for (IndexType j = i; j < end; ++j){
+						nonZeroNum += w[j] != 0;
+					}
+					continue;
+				}
+				for (IndexType j = i; j < end; ++j){
+					nonZeroNum += this->IsNonZero(weightMatrix, j);
+				}
+			}
+			size_t table_size = 16;
+			int table_bits = 4;
+			while (table_size < nonZeroNum * 2){
+				table_size *= 2;
+				table_bits++;
+			}
+			size_t hashed_bytes = table_size * sizeof(entry) + (nonZeroNum + 1) * K * sizeof(float);
+			this->is_hashed = hashed_bytes * 2 < dense_bytes;
+
+			if (this->is_hashed == false){
+				this->rows.erase();
+				this->table.erase();
+				this->feat_num = 0;
+				if (K == 1){
+					return false;
+				}
+				this->dim = weightDim;
+				this->feat_num = weightDim;
+				this->rows.resize(((size_t)weightDim + 1) * K);
+				this->rows.zeros(this->rows.begin, this->rows.begin + K);
+				for (IndexType i = 0; i < weightDim; ++i){
+					for (int k = 0; k < K; ++k){
+						this->rows[((size_t)i + 1) * K + k] = weightMatrix[k][i] * scales[k];
+					}
+				}
+				return true;
+			}
+
+			this->dim = 0;
+			this->feat_num = nonZeroNum;
+			this->mask = table_size - 1;
+			this->table_bits = table_bits;
+			this->table.resize(table_size);
+			for (size_t j = 0; j < table_size; ++j){
+				this->table[j].key = EMPTY_KEY;
+				this->table[j].row = 0;
+			}
+			this->rows.resize((nonZeroNum + 1) * K);
+			this->rows.zeros(this->rows.begin, this->rows.begin + K);
+			uint32_t row = 0;
+			for (IndexType i = 0; i < weightDim; ++i){
+				if (this->IsNonZero(weightMatrix, i) == false){
+					continue;
+				}
+				++row;
+				size_t pos = this->Hash(i);
+				while (this->table[pos].key != EMPTY_KEY){
+					pos = (pos + 1) & this->mask;
+				}
+				this->table[pos].key = i;
+				this->table[pos].row = row;
+				for (int k = 0; k < K; ++k){
+					this->rows[(size_t)row * K + k] = weightMatrix[k][i] * scales[k];
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * @Synopsis Predict compute the scores of all the classifiers
+		 *
+		 * @Param data input data sample
+		 * @Param predicts score of each classifier
+		 */
+		inline void Predict(const DataPoint<FeatType, LabelType> &data, float* predicts) const {
+			int K = this->classfier_num;
+			const IndexType* idx = data.indexes.begin;
+			const FeatType* x = data.features.begin;
+			size_t n = data.indexes.size();
+			const float* rows = this->rows.begin;
+			if (K == 1){
+				float sum = 0;
+				for (size_t i = 0; i < n; ++i){
+					sum += rows[this->Row(idx[i])] * x[i];
+				}
+				predicts[0] = sum + this->bias[0];
+				return;
+			}
+			for (int k = 0; k < K; ++k){
+				predicts[k] = this->bias[k];
+			}
+			for (size_t i = 0; i < n; ++i){
+				const float* w = rows + (size_t)this->Row(idx[i]) * K;
+				for (int k = 0; k < K; ++k){
+					predicts[k] += w[k] * x[i];
+				}
+			}
+		}
+
+	protected:
+		//Fibonacci hashing, the top bits of the product depend on all the bits
+		//of the index, so that strided indexes are spread over the table
+		inline size_t Hash(IndexType index) const {
+			return (size_t)(((uint64_t)index * 0x9E3779B97F4A7C15ull) >> (64 - this->table_bits));
+		}
+
+		//row of a feature, 0 if it is not in the model
+		inline uint32_t Row(IndexType index) const {
+			if (this->is_hashed == false){
+				return index < this->dim ? index + 1 : 0;
+			}
+			size_t pos = this->Hash(index);
+			const entry* table = this->table.begin;
+			//the probe stops at the feature or an empty entry, whose row is 0
+			while (table[pos].key != index && table[pos].key != EMPTY_KEY){
+				pos = (pos + 1) & this->mask;
+			}
+			return table[pos].row;
+		}
+
+		static inline bool IsNonZero(const std::vector<s_array<float> > &weightMatrix, IndexType i) {
+			for (size_t k = 0; k < weightMatrix.size(); ++k){
+				if (weightMatrix[k][i] != 0){
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+}
+
+#endif
@@ -8,8 +8,18 @@
 #define HEADER_ONLINE_LINEAR_MODEL
 
 #include "../OnlineModel.h"
+#include "FrozenPredictor.h"
+#include "../../../utils/sparse_kernel.h"
+#include "../../../utils/scaled_array.h"
+#include "../../../utils/feature_map.h"
+#include "../../../utils/mapped_file.h"
+#include "../../../utils/state_io.h"
 
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <algorithm>
 
@@ -17,6 +27,33 @@
 *  namespace: Batch and Online Classification
 */
 namespace BOC {
+	/**
+	 * header of the binary model files, written as it is. The offsets are from
+	 * the beginning of the file and aligned to 64 bytes, so that the dense
+	 * weights can be used directly from the mapped file.
+	 */
+	struct ModelFileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t classfier_num;
+		uint64_t weight_dim;
+		//whether the weights are saved as (index, value) pairs
+		uint32_t is_sparse;
+		//length of the config in text, right after the header
+		uint32_t config_len;
+		uint64_t value_offset;
+		//state of the optimization, 0 length if not saved
+		uint64_t state_offset;
+		uint64_t state_len;
+		char reserved[8];
+
+		ModelFileHeader() {
+			std::memset(this, 0, sizeof(ModelFileHeader));
+			std::memcpy(this->magic, "SOLMODEL", 8);
+			this->version = 1;
+		}
+	};
+
 	template <typename FeatType, typename LabelType>
 	class OnlineLinearModel : public OnlineModel < FeatType, LabelType > {
 
@@ -34,13 +71,53 @@ namespace BOC {
 
 		//weight dimension: can be the same to feature, or with an extra bias
 		IndexType weightDim;
+
+		//accumulated (index, gradient) pairs of a mini-batch for each classifier
+		vector<vector<std::pair<IndexType, float> > > batchPairs;
+		//merged sparse gradient of a mini-batch for each classifier
+		vector<DataPoint<FeatType, LabelType> > batchGrads;
+		//accumulated gradient of the bias for each classifier
+		s_array<float> batchBiasGrads;
+		//labels and loss gradients of a mini-batch of binary classification
+		s_array<LabelType> batchLabels;
+		s_array<float> batchLossGrads;
+
+		//whether the weights gathered in prediction are reused in the update of binary classification
+		bool reuseGathered;
+		//weights gathered in the prediction of the current example, valid if isGathered is true
+		s_array<float> gatheredWeights;
+		bool isGathered;
+
+		//scale factor and squared norm of each weight vector, weights are
+		//scaledWeights[k].get_scale() * weightMatrix[k] during training
+		vector<scaled_array<float> > scaledWeights;
+		//whether the squared norms of weight vectors are required
+		bool isTrackNorm;
+
+		//format of the saved model, binary or text
+		string modelFormat;
+		//file of the loaded binary model, dense weights are kept in its memory
+		mapped_file modelMap;
+		//whether the state of the optimization is saved or loaded with the
+		//model, and the state of the optimizer kept with it
+		bool isCheckpoint;
+		string checkpointProgress;
+
+		//compact copy of the weights for prediction, used if isFrozen is true
+		//and no iteration is done since it is compiled
+		FrozenPredictor<FeatType, LabelType> frozen;
+		bool isFrozen;
+		size_t frozenIterNum;
 #pragma endregion Class Members
 
 #pragma region Constructors and Basic Functions
 	public:
 		OnlineLinearModel(LossFunction<FeatType, LabelType> *lossFunc, int classNum)
-			: OnlineModel<FeatType, LabelType>(lossFunc, classNum), pWeightVecBC(NULL) {
+			: OnlineModel<FeatType, LabelType>(lossFunc, classNum), pWeightVecBC(NULL),
+			reuseGathered(false), isGathered(false), isTrackNorm(false), isCheckpoint(false),
+			isFrozen(false), frozenIterNum(0) {
 			this->weightDim = 1;
+			this->modelFormat = init_model_format;
 			this->weightMatrix.resize(this->classfier_num);
 
 			for (int i = 0; i < this->classfier_num; ++i){
@@ -55,6 +132,13 @@ namespace BOC {
 			}
 
 			this->classifier_weight.resize(this->classfier_num);
+
+			this->batchPairs.resize(this->classfier_num);
+			this->batchGrads.resize(this->classfier_num);
+			this->batchBiasGrads.resize(this->classfier_num);
+
+			this->scaledWeights.resize(this->classfier_num);
+			this->AttachScaledWeights();
 		}
 
 		virtual ~OnlineLinearModel() {
@@ -67,6 +151,7 @@ namespace BOC {
 			OnlineModel<FeatType, LabelType>::PrintModelSettings();
 
 			printf("Linear Model: y = w * x + b \n");
+			printf("\tSparse Kernel: %s\n", sparse_kernel().name);
 		}
 
 		/**
@@ -88,13 +173,13 @@ namespace BOC {
 			printf("Sparsification Rate: %g %%\n", sparseRate * 100);
 		}
 
-	protected:
+	public:
 		/**
 		 * @Synopsis GetNonZeroNum get the number of nonzero weights
 		 *
 		 * @Returns number of nonzero weights
 		 */
-		IndexType GetNonZeroNum()  const {
+		virtual IndexType GetNonZeroNum()  const {
 			IndexType nonZeroNum = 0;
 			s_array<float> weightVec = this->weightMatrix[0];
 			for (IndexType i = 1; i < this->weightDim; ++i){
@@ -110,34 +195,75 @@ namespace BOC {
 #pragma region  IO related
 	public:
 		/**
-		 * @Synopsis SaveModel save model to disk
+		 * @Synopsis SaveModel save model to disk, in binary or text format
 		 *
 		 * @Param filename  name to the saved file
 		 *
 		 * @Returns true if load successfully
 		 */
 		virtual bool SaveModel(const string& filename) {
-			std::ofstream outfile(filename.c_str(), ios::out | ios::binary);
+			//write to a temporary file first, so that the file is complete once
+			//it exists, and a model mapped from it is not changed
+			string tmp_filename = filename + ".tmp";
+			std::ofstream outfile(tmp_filename.c_str(), ios::out | ios::binary);
 			if (!outfile){
-				fprintf(stderr, "open file %s failed!\n", filename.c_str());
+				fprintf(stderr, "open file %s failed!\n", tmp_filename.c_str());
 				return false;
 			}
 
-			this->SaveModelConfig(outfile);
-			this->SaveModelValue(outfile);
+			bool ret = false;
+			if (this->modelFormat == "text"){
+				ret = this->SaveModelConfig(outfile) && this->SaveModelValue(outfile);
+			}
+			else{
+				ret = this->SaveModelBinary(outfile);
+			}
 
 			outfile.close();
+			if (ret == false || !outfile){
+				fprintf(stderr, "write file %s failed!\n", tmp_filename.c_str());
+				std::remove(tmp_filename.c_str());
+				return false;
+			}
+#if WIN32
+			std::remove(filename.c_str());
+#endif
+			if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0){
+				fprintf(stderr, "rename %s to %s failed!\n", tmp_filename.c_str(), filename.c_str());
+				return false;
+			}
 			return true;
 		}
 
 		/**
-		 * @Synopsis LoadModel load model from disk
+		 * @Synopsis LoadModel load model from disk, the format is detected
 		 *
 		 * @Param filename  path name of the model on disk
 		 *
 		 * @Returns true if load successfully
 		 */
 		virtual bool LoadModel(const string& filename) {
+			//the weights may be in the memory of the last loaded model
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (this->weightMatrix[k].is_owner == false){
+					this->weightMatrix[k] = s_array<float>();
+				}
+			}
+			this->isFrozen = false;
+			if (this->modelMap.open(filename) == false){
+				fprintf(stderr, "open file %s failed!\n", filename.c_str());
+				return false;
+			}
+			if (this->modelMap.size() >= sizeof(ModelFileHeader) &&
+				std::memcmp(this->modelMap.begin(), "SOLMODEL", 8) == 0){
+				return this->LoadModelBinary();
+			}
+			this->modelMap.close();
+			if (this->isCheckpoint == true){
+				fprintf(stderr, "%s is not a checkpoint!\n", filename.c_str());
+				return false;
+			}
+
 			std::ifstream infile(filename.c_str(), ios::in | ios::binary);
 			if (!infile){
 				fprintf(stderr, "open file %s failed!\n", filename.c_str());
@@ -151,6 +277,45 @@ namespace BOC {
 			return true;
 		}
 
+		/**
+		 * @Synopsis SaveCheckpoint save the model in binary format with the
+		 * state of the optimization
+		 *
+		 * @Param filename path of the checkpoint
+		 * @Param progress state of the optimizer, saved as it is
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveCheckpoint(const string &filename, const string &progress) {
+			string format = this->modelFormat;
+			this->modelFormat = "binary";
+			this->isCheckpoint = true;
+			this->checkpointProgress = progress;
+			bool ret = this->SaveModel(filename);
+			this->isCheckpoint = false;
+			this->checkpointProgress.clear();
+			this->modelFormat = format;
+			return ret;
+		}
+
+		/**
+		 * @Synopsis LoadCheckpoint load the model and the state of the
+		 * optimization saved by SaveCheckpoint
+		 *
+		 * @Param filename path of the checkpoint
+		 * @Param progress state of the optimizer
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadCheckpoint(const string &filename, string &progress) {
+			this->isCheckpoint = true;
+			bool ret = this->LoadModel(filename);
+			this->isCheckpoint = false;
+			progress.swap(this->checkpointProgress);
+			this->checkpointProgress.clear();
+			return ret;
+		}
+
 	protected:
 		/**
 		 * @Synopsis SaveModelConfig save configuration of model to disk
@@ -159,7 +324,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelConfig(std::ofstream &os) {
+		virtual bool SaveModelConfig(std::ostream &os) {
 			//model
 			os << "[model]\n";
 			os << "y = w * x + b\n";
@@ -180,7 +345,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelConfig(std::ifstream &is) {
+		virtual bool LoadModelConfig(std::istream &is) {
 			//model
 			std::string line;
 			getline(is, line);
@@ -211,7 +376,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelValue(std::ofstream &os) {
+		virtual bool SaveModelValue(std::ostream &os) {
 			//weight dimension
 			os << "[value]\n";
 			os << "classfier num: " << this->classfier_num << "\n";
@@ -220,9 +385,12 @@ namespace BOC {
 			for (int k = 0; k < this->classfier_num; ++k){
 				os << k << " | ";
 				s_array<float>& weightVec = this->weightMatrix[k];
+				float scale = this->WeightScale(k);
+				//the original feature indexes are saved if they are mapped
+				bool is_mapped = this->IsFeatureMapped();
 				for (IndexType i = 0; i < this->weightDim; i++){
 					if (weightVec[i] != 0){
-						os << i << ":" << weightVec[i] << "\t";
+						os << (is_mapped ? this->featMap->raw_index(i) : i) << ":" << weightVec[i] * scale << "\t";
 					}
 				}
 				os << "\n";
@@ -238,7 +406,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelValue(std::ifstream &is) {
+		virtual bool LoadModelValue(std::istream &is) {
 			//weight dimension
 			string line;
 
@@ -265,6 +433,7 @@ namespace BOC {
 				getline(is, line);
 				ret = LoadWeights(line.c_str());
 			} while (ret == STATUS_OK);
+			this->AttachScaledWeights();
 			if (ret == STATUS_END_OF_FILE){
 				return true;
 			}
@@ -295,7 +464,6 @@ namespace BOC {
 					endptr = ++p;
 				}
 
-				s_array<float>& weightVec = this->weightMatrix[classifier_id];
 
 				IndexType index;
 				FeatType feat;
@@ -321,12 +489,265 @@ namespace BOC {
 						fprintf(stderr, "parse feature value failed!\n");
 						return STATUS_INVALID_FILE;
 					}
-					weightVec[index] = feat;
+					this->SetLoadedWeight(classifier_id, index, feat);
 				}
 
 				return STATUS_OK;
 			}
 
+			/**
+			 * @Synopsis SetLoadedWeight set a weight read from a model file
+			 *
+			 * @Param k index of the classifier
+			 * @Param index original index of the feature
+			 * @Param val value of the weight
+			 */
+			inline void SetLoadedWeight(int k, IndexType index, float val) {
+				if (this->IsFeatureMapped() == true){
+					index = this->featMap->promote(index);
+				}
+				if (index >= this->weightDim){
+					OnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(index);
+				}
+				this->weightMatrix[k][index] = val;
+			}
+
+			//pad the stream with zeros to a multiple of 64 bytes
+			static void WritePadding(std::ostream &os) {
+				static const char zeros[64] = { 0 };
+				size_t pos = (size_t)os.tellp();
+				if (pos % 64 != 0){
+					os.write(zeros, 64 - pos % 64);
+				}
+			}
+
+			static inline size_t AlignSize(size_t len) {
+				return (len + 63) / 64 * 64;
+			}
+
+			/**
+			 * @Synopsis SaveModelBinary save model in the binary format: the
+			 * header, the config in text, the weights and the state of the
+			 * optimization. The weights are dense arrays, or (index, value)
+			 * pairs if they are sparse or the feature indexes are mapped.
+			 *
+			 * @Param os seekable stream to which the model is saved
+			 *
+			 * @Returns true if saved successfully
+			 */
+			bool SaveModelBinary(std::ostream &os) {
+				bool is_mapped = this->IsFeatureMapped();
+				ModelFileHeader header;
+				header.classfier_num = this->classfier_num;
+				header.weight_dim = this->weightDim;
+
+				uint64_t nonZeroNum = 0;
+				for (int k = 0; k < this->classfier_num; ++k){
+					const s_array<float>& weightVec = this->weightMatrix[k];
+					for (IndexType i = 0; i < this->weightDim; ++i){
+						nonZeroNum += weightVec[i] != 0;
+					}
+				}
+				//a pair takes twice the space of a dense weight
+				header.is_sparse = is_mapped ||
+					nonZeroNum * 2 < (uint64_t)this->classfier_num * this->weightDim;
+
+				std::ostringstream config;
+				this->SaveModelConfig(config);
+				string config_str = config.str();
+				header.config_len = (uint32_t)config_str.size();
+				os.write((const char*)&header, sizeof(header));
+				os.write(config_str.data(), config_str.size());
+				WritePadding(os);
+
+				header.value_offset = (uint64_t)os.tellp();
+				vector<IndexType> indexes;
+				vector<float> values;
+				for (int k = 0; k < this->classfier_num; ++k){
+					const s_array<float>& weightVec = this->weightMatrix[k];
+					float scale = this->WeightScale(k);
+					if (header.is_sparse == 0){
+						if (scale == 1){
+							os.write((const char*)weightVec.begin, sizeof(float) * this->weightDim);
+						}
+						else{
+							values.resize(this->weightDim);
+							for (IndexType i = 0; i < this->weightDim; ++i){
+								values[i] = weightVec[i] * scale;
+							}
+							os.write((const char*)&values[0], sizeof(float) * this->weightDim);
+						}
+						WritePadding(os);
+						continue;
+					}
+					indexes.clear();
+					values.clear();
+					for (IndexType i = 0; i < this->weightDim; ++i){
+						if (weightVec[i] != 0){
+							//the original feature indexes are saved if they are mapped
+							indexes.push_back(is_mapped ? this->featMap->raw_index(i) : i);
+							values.push_back(weightVec[i] * scale);
+						}
+					}
+					uint64_t n = indexes.size();
+					os.write((const char*)&n, sizeof(n));
+					if (n > 0){
+						os.write((const char*)&indexes[0], sizeof(IndexType) * n);
+						os.write((const char*)&values[0], sizeof(float) * n);
+					}
+				}
+				WritePadding(os);
+
+				header.state_offset = (uint64_t)os.tellp();
+				if (this->isCheckpoint == true){
+					write_string(os, this->checkpointProgress);
+					if (this->SaveModelState(os) == false){
+						return false;
+					}
+				}
+				header.state_len = (uint64_t)os.tellp() - header.state_offset;
+
+				os.seekp(0);
+				os.write((const char*)&header, sizeof(header));
+				return os.good();
+			}
+
+			/**
+			 * @Synopsis LoadModelBinary load model from the mapped binary
+			 * file, the dense weights are not copied unless they are modified
+			 *
+			 * @Returns true if load successfully
+			 */
+			bool LoadModelBinary() {
+				const char* data = this->modelMap.begin();
+				size_t file_size = this->modelMap.size();
+				ModelFileHeader header;
+				std::memcpy(&header, data, sizeof(header));
+				if (header.version != 1){
+					fprintf(stderr, "unsupported model version %u\n", header.version);
+					return false;
+				}
+				if ((int)header.classfier_num != this->classfier_num){
+					fprintf(stderr, "the model has %u classifiers, %d are expected\n",
+						header.classfier_num, this->classfier_num);
+					return false;
+				}
+				if (sizeof(header) + header.config_len > file_size || header.value_offset > file_size ||
+					header.state_offset + header.state_len > file_size){
+					fprintf(stderr, "incorrect model file!\n");
+					return false;
+				}
+
+				std::istringstream config(string(data + sizeof(header), header.config_len));
+				this->LoadModelConfig(config);
+
+				bool is_mapped = this->IsFeatureMapped();
+				//the states not in the checkpoint grow with the weights
+				if (this->isCheckpoint == true && header.weight_dim > 0){
+					this->UpdateModelDimention((IndexType)header.weight_dim - 1);
+				}
+				this->weightDim = (IndexType)header.weight_dim;
+				const char* p = data + header.value_offset;
+				const char* p_end = data + header.state_offset;
+				for (int k = 0; k < this->classfier_num; ++k){
+					s_array<float>& weightVec = this->weightMatrix[k];
+					const IndexType* indexes = NULL;
+					const float* values = NULL;
+					uint64_t n = 0;
+					if (header.is_sparse == 0){
+						values = (const float*)p;
+						n = header.weight_dim;
+						p += AlignSize(sizeof(float) * n);
+					}
+					else if (p + sizeof(n) <= p_end){
+						std::memcpy(&n, p, sizeof(n));
+						indexes = (const IndexType*)(p + sizeof(n));
+						values = (const float*)(indexes + n);
+						p = (const char*)(values + n);
+					}
+					else{
+						p = p_end + 1;
+					}
+					if (p > p_end){
+						fprintf(stderr, "incorrect model file!\n");
+						return false;
+					}
+					if (header.is_sparse == 0 && is_mapped == false){
+						weightVec.attach(const_cast<float*>(values), this->weightDim);
+						continue;
+					}
+					weightVec.resize(this->weightDim);
+					weightVec.zeros();
+					for (uint64_t i = 0; i < n; ++i){
+						if (values[i] != 0){
+							this->SetLoadedWeight(k, indexes != NULL ? indexes[i] : (IndexType)i, values[i]);
+						}
+					}
+				}
+				this->AttachScaledWeights();
+				if (this->isCheckpoint == false){
+					return true;
+				}
+				state_reader reader(data + header.state_offset, (size_t)header.state_len);
+				if (header.state_len == 0 || reader.read_string(this->checkpointProgress) == false ||
+					this->LoadModelState(reader) == false || reader.ok() == false){
+					fprintf(stderr, "incorrect training state in the checkpoint!\n");
+					return false;
+				}
+				return true;
+			}
+
+			/**
+			 * @Synopsis SaveModelState save the state of the optimization to
+			 * the checkpoint, the models save their own states after those of
+			 * the base class
+			 *
+			 * @Param os ostream object to which the state is saved
+			 *
+			 * @Returns true if saved successfully
+			 */
+			virtual bool SaveModelState(std::ostream &os) {
+				write_value(os, (uint64_t)this->curIterNum);
+				write_value(os, this->eta);
+				write_array(os, this->classifier_weight);
+				//the saved weights are scaled, the values are saved again to
+				//resume with the same rounding
+				for (int k = 0; k < this->classfier_num; ++k){
+					const scaled_array<float> &scaledWeight = this->scaledWeights[k];
+					scaledWeight.save(os);
+					if (scaledWeight.get_scale() != 1){
+						write_array(os, this->weightMatrix[k]);
+					}
+				}
+				return os.good();
+			}
+
+			/**
+			 * @Synopsis LoadModelState load the state of the optimization,
+			 * after the weights are loaded
+			 *
+			 * @Param reader the state in the mapped checkpoint
+			 *
+			 * @Returns true if load successfully
+			 */
+			virtual bool LoadModelState(state_reader &reader) {
+				uint64_t iterNum = 0;
+				reader.read_value(iterNum);
+				this->curIterNum = (size_t)iterNum;
+				reader.read_value(this->eta);
+				reader.read_array(this->classifier_weight);
+				for (int k = 0; k < this->classfier_num; ++k){
+					scaled_array<float> &scaledWeight = this->scaledWeights[k];
+					if (scaledWeight.load(reader) == false){
+						return false;
+					}
+					if (scaledWeight.get_scale() != 1){
+						reader.read_array(this->weightMatrix[k]);
+					}
+				}
+				return reader.ok();
+			}
+
 #pragma endregion  IO related
 
 #pragma region Train Related
@@ -336,11 +757,13 @@ namespace BOC {
 		 */
 		virtual void BeginTrain() {
 			OnlineModel<FeatType, LabelType>::BeginTrain();
+			this->isFrozen = false;
 
 			//reset weight vector
 			for (int i = 0; i < this->classfier_num; ++i){
 				this->weightMatrix[i].set_value(0);
 			}
+			this->AttachScaledWeights();
 			this->classifier_weight.set_value(1.f);
 		}
 
@@ -348,9 +771,30 @@ namespace BOC {
 		 * @Synopsis EndTrain called when a train ends
 		 */
 		virtual void EndTrain() {
+			//fold the scale factors into the weights
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->scaledWeights[k].normalize();
+			}
 			OnlineModel<FeatType, LabelType>::EndTrain();
+			this->isFrozen = false;
 		}
 
+	protected:
+		//use the weight vectors as the values of the scaled arrays
+		void AttachScaledWeights() {
+			this->scaledWeights.resize(this->classfier_num);
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->scaledWeights[k].attach(this->weightMatrix[k], this->isTrackNorm);
+			}
+		}
+
+		//scale factor of the k-th weight vector
+		inline float WeightScale(int k) const {
+			return this->scaledWeights[k].get_scale();
+		}
+
+	public:
+
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -370,6 +814,7 @@ namespace BOC {
 						weightVec.end);
 				}
 				this->weightDim = new_dim;
+				this->isFrozen = false;
 			}
 		}
 
@@ -379,6 +824,9 @@ namespace BOC {
 		 */
 		virtual void SetParameter(BOC::Params &param){
 			OnlineModel<FeatType, LabelType>::SetParameter(param);
+			this->modelFormat = param.StringValue("-mf");
+			INVALID_ARGUMENT_EXCEPTION(modelFormat, this->modelFormat == "binary" ||
+				this->modelFormat == "text", "binary or text");
 		}
 
 		/**
@@ -390,13 +838,19 @@ namespace BOC {
 		 */
 		virtual int IterateBC(const DataPoint<FeatType, LabelType> &x, float* predict){
 			this->curIterNum++;
-			*predict = this->TrainPredict(*this->pWeightVecBC, x);
+			if (this->reuseGathered == true){
+				*predict = this->TrainPredictGather(*this->pWeightVecBC, x) * this->WeightScale(0);
+			}
+			else{
+				*predict = this->TrainPredict(*this->pWeightVecBC, x) * this->WeightScale(0);
+			}
 			int label = this->GetClassLabel(x);
 			float gt = 0;
 			this->lossFunc->GetGradient(label, predict, &gt);
 			if (gt != 0){
 				this->UpdateWeightVec(x, &gt);
 			}
+			this->isGathered = false;
 			if (this->IsCorrect(label, predict) == false){
 				return -label;
 			}
@@ -415,7 +869,7 @@ namespace BOC {
 		virtual int IterateMC(const DataPoint<FeatType, LabelType> &x, float* predict){
 			this->curIterNum++;
 			for (int k = 0; k < this->classfier_num; ++k){
-				predict[k] = this->TrainPredict(this->weightMatrix[k], x);
+				predict[k] = this->TrainPredict(this->weightMatrix[k], x) * this->WeightScale(k);
 			}
 
 			this->lossFunc->GetGradient(x.label, predict, this->mc_gradients.begin, this->classifier_weight.begin, this->classfier_num);
@@ -428,6 +882,180 @@ namespace BOC {
 			return x.label;
 		}
 
+		/**
+		 * @Synopsis IterateChunk Iteration of online learning on all the examples of
+		 * a chunk, the weights of the next example are prefetched while iterating
+		 * the current one
+		 *
+		 * @Param chunk examples to iterate
+		 * @Param predict buffer of the predicted values, classifier number
+		 * @Param stat training statistics
+		 */
+		virtual void IterateChunk(DataChunk<DataPoint<FeatType, LabelType> > &chunk, float* predict,
+			IterateStat &stat){
+			if (this->classfier_num != 1){
+				OnlineModel<FeatType, LabelType>::IterateChunk(chunk, predict, stat);
+				return;
+			}
+			this->UpdateModelDimention(chunk.max_index);
+			for (size_t j = 0; j < chunk.dataNum; ++j){
+				if (j + 1 < chunk.dataNum){
+					this->PrefetchWeights(chunk.data[j + 1]);
+				}
+				DataPoint<FeatType, LabelType> &data = chunk.data[j];
+				stat.Add(data, predict, this->IterateBC(data, predict), 1);
+			}
+		}
+
+		/**
+		 * @Synopsis PrefetchWeights prefetch the weights of an example
+		 *
+		 * @Param x the example
+		 */
+		virtual void PrefetchWeights(const DataPoint<FeatType, LabelType> &x) const {
+			for (int k = 0; k < this->classfier_num; ++k){
+				sparse_prefetch(this->weightMatrix[k].begin, x.indexes.begin, x.indexes.size());
+			}
+		}
+
+		/**
+		 * @Synopsis IterateBatch Iteration of online learning on a mini-batch. All the
+		 * examples are predicted with the same weights, their gradients are
+		 * accumulated and merged by index, and applied in one update.
+		 *
+		 * @Param data the first example of the mini-batch
+		 * @Param num number of examples in the mini-batch
+		 * @Param predicts predicted values of each example, num * classifier number
+		 * @Param predictLabels predicted class of each example
+		 */
+		virtual void IterateBatch(const DataPoint<FeatType, LabelType> *data, size_t num,
+			float* predicts, int* predictLabels){
+			if (this->IsBatchSupported() == false){
+				OnlineModel<FeatType, LabelType>::IterateBatch(data, num, predicts, predictLabels);
+				return;
+			}
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->batchPairs[k].clear();
+			}
+			this->batchBiasGrads.zeros();
+
+			//predict with the weights of the last batch, the weights are read only here
+			if (this->classfier_num == 1){
+				this->batchLabels.resize(num);
+				this->batchLossGrads.resize(num);
+				for (size_t j = 0; j < num; ++j){
+					predicts[j] = this->TrainPredict(*this->pWeightVecBC, data[j]) * this->WeightScale(0);
+					this->batchLabels[j] = (LabelType)this->GetClassLabel(data[j]);
+				}
+				//the gradients of the mini-batch are computed together
+				this->lossFunc->GetGradients(this->batchLabels.begin, predicts, this->batchLossGrads.begin, num);
+				for (size_t j = 0; j < num; ++j){
+					const DataPoint<FeatType, LabelType> &x = data[j];
+					int label = this->batchLabels[j];
+					if (this->batchLossGrads[j] != 0){
+						this->AccumulateGradient(0, x, this->batchLossGrads[j]);
+					}
+					predictLabels[j] = this->IsCorrect(label, predicts + j) == false ? -label : x.label;
+				}
+			}
+			else{
+				for (size_t j = 0; j < num; ++j){
+					const DataPoint<FeatType, LabelType> &x = data[j];
+					float* predict = predicts + j * this->classfier_num;
+					for (int k = 0; k < this->classfier_num; ++k){
+						predict[k] = this->TrainPredict(this->weightMatrix[k], x) * this->WeightScale(k);
+					}
+					this->lossFunc->GetGradient(x.label, predict, this->mc_gradients.begin,
+						this->classifier_weight.begin, this->classfier_num);
+					if (this->mc_gradients[x.label] != 0){
+						for (int k = 0; k < this->classfier_num; ++k){
+							if (this->mc_gradients[k] != 0){
+								this->AccumulateGradient(k, x, this->mc_gradients[k]);
+							}
+						}
+						predictLabels[j] = int(std::max_element(predict, predict + this->classfier_num) - predict);
+					}
+					else{
+						predictLabels[j] = x.label;
+					}
+				}
+			}
+			this->curIterNum += num;
+
+			//merge the gradients of the same feature
+			bool is_update = false;
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->MergeGradient(this->batchPairs[k], this->batchGrads[k]);
+				if (this->batchBiasGrads[k] != 0 || this->batchGrads[k].indexes.empty() == false){
+					is_update = true;
+				}
+			}
+			if (is_update == true){
+				this->UpdateWeightVecBatch(this->batchGrads, this->batchBiasGrads.begin);
+			}
+		}
+
+	protected:
+		/**
+		 * @Synopsis AccumulateGradient add the gradient of an example to the
+		 * mini-batch accumulator
+		 *
+		 * @Param k index of the classifier
+		 * @Param x current input data example
+		 * @Param gt common part of the gradient
+		 */
+		inline void AccumulateGradient(int k, const DataPoint<FeatType, LabelType> &x, float gt){
+			vector<std::pair<IndexType, float> > &pairs = this->batchPairs[k];
+			size_t featDim = x.indexes.size();
+			for (size_t i = 0; i < featDim; ++i){
+				pairs.push_back(std::make_pair(x.indexes[i], gt * x.features[i]));
+			}
+			this->batchBiasGrads[k] += gt;
+		}
+
+		/**
+		 * @Synopsis MergeGradient sort the accumulated pairs by index and merge the
+		 * duplicated indexes into a sparse gradient
+		 *
+		 * @Param pairs accumulated (index, gradient) pairs
+		 * @Param grad merged sparse gradient
+		 */
+		void MergeGradient(vector<std::pair<IndexType, float> > &pairs, DataPoint<FeatType, LabelType> &grad){
+			grad.indexes.erase();
+			grad.features.erase();
+			if (pairs.empty() == true){
+				return;
+			}
+			std::sort(pairs.begin(), pairs.end());
+			grad.indexes.reserve(pairs.size());
+			grad.features.reserve(pairs.size());
+			grad.indexes.push_back(pairs[0].first);
+			grad.features.push_back(pairs[0].second);
+			size_t pairNum = pairs.size();
+			for (size_t i = 1; i < pairNum; ++i){
+				if (pairs[i].first == grad.indexes.last()){
+					*(grad.features.end - 1) += pairs[i].second;
+				}
+				else{
+					grad.indexes.push_back(pairs[i].first);
+					grad.features.push_back(pairs[i].second);
+				}
+			}
+			//sorted and merged, only the range of the indexes is left to check
+			grad.is_strict = sparse_is_strict(grad.indexes.end - 1, 1);
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVecBatch apply the merged gradients of a mini-batch,
+		 * models supporting mini-batch should override this function
+		 *
+		 * @Param grads merged sparse gradient for each classifier
+		 * @Param biasGrads accumulated gradient of bias for each classifier
+		 */
+		virtual void UpdateWeightVecBatch(const vector<DataPoint<FeatType, LabelType> > &grads, const float* biasGrads){
+			fprintf(stderr, "mini-batch is not supported by %s\n", this->modelName.c_str());
+		}
+
 	protected:
 		/**
 		 * @Synopsis TrainPredict prediction function for training
@@ -438,13 +1066,26 @@ namespace BOC {
 		 * @Returns predicted value
 		 */
 		virtual float TrainPredict(const s_array<float> &weightVec, const DataPoint<FeatType, LabelType> &data) {
-			float predict = 0;
+			return sparse_dot(weightVec.begin, data.indexes.begin, data.features.begin,
+				data.indexes.size(), data.is_strict, NULL) + weightVec[0];
+		}
+
+		/**
+		 * @Synopsis TrainPredictGather prediction function for training, the
+		 * gathered weights are kept in gatheredWeights so that the update of the
+		 * same example does not gather them again
+		 *
+		 * @Param weightVec weight vector
+		 * @Param data input data sample
+		 *
+		 * @Returns predicted value
+		 */
+		float TrainPredictGather(const s_array<float> &weightVec, const DataPoint<FeatType, LabelType> &data) {
 			size_t dim = data.indexes.size();
-			for (size_t i = 0; i < dim; i++){
-				predict += weightVec[data.indexes[i]] * data.features[i];
-			}
-			predict += weightVec[0];
-			return predict;
+			this->gatheredWeights.resize(dim);
+			this->isGathered = true;
+			return sparse_dot(weightVec.begin, data.indexes.begin, data.features.begin,
+				dim, data.is_strict, this->gatheredWeights.begin) + weightVec[0];
 		}
 
 		/**
@@ -460,6 +1101,19 @@ namespace BOC {
 
 #pragma region	Test related
 	public:
+		/**
+		 * @Synopsis Freeze compile the weights into the compact predictor,
+		 * which is used by Predict until the model is trained again
+		 */
+		virtual void Freeze() {
+			vector<float> scales(this->classfier_num);
+			for (int k = 0; k < this->classfier_num; ++k){
+				scales[k] = this->WeightScale(k);
+			}
+			this->isFrozen = this->frozen.Compile(this->weightMatrix, &scales[0], this->weightDim);
+			this->frozenIterNum = this->curIterNum;
+		}
+
 		/**
 		 * @Synopsis Predict prediction function for test
 		 *
@@ -469,9 +1123,7 @@ namespace BOC {
 		 * @Returns predicted class
 		 */
 		virtual int Predict(const DataPoint<FeatType, LabelType> &data, float* predicts){
-			for (int k = 0; k < this->classfier_num; ++k){
-				predicts[k] = this->TestPredict(this->weightMatrix[k], data);
-			}
+			this->PredictScores(data, predicts);
 			if (this->classfier_num == 1){
 				int label = this->GetClassLabel(data);
 				if (this->IsCorrect(label, predicts) == false){
@@ -487,6 +1139,23 @@ namespace BOC {
 		}
 
 	protected:
+		/**
+		 * @Synopsis PredictScores predicted values of each classifier for test
+		 *
+		 * @Param data input data sample
+		 * @Param predicts predicted values for each classifier
+		 */
+		virtual void PredictScores(const DataPoint<FeatType, LabelType> &data, float* predicts){
+			if (this->isFrozen == true && this->frozenIterNum == this->curIterNum){
+				this->frozen.Predict(data, predicts);
+			}
+			else{
+				for (int k = 0; k < this->classfier_num; ++k){
+					predicts[k] = this->TestPredict(this->weightMatrix[k], data) * this->WeightScale(k);
+				}
+			}
+		}
+
 		/**
 		 * @Synopsis TestPredict prediction function for test
 		 *
@@ -496,8 +1165,13 @@ namespace BOC {
 		 * @Returns predicted value
 		 */
 		float TestPredict(const s_array<float> &weightVec, const DataPoint<FeatType, LabelType> &data) {
-			float predict = 0;
 			size_t dim = data.indexes.size();
+			//no bounds check if all the features are within the model
+			if (data.dim() < this->weightDim){
+				return sparse_dot(weightVec.begin, data.indexes.begin, data.features.begin,
+					dim, data.is_strict, NULL) + weightVec[0];
+			}
+			float predict = 0;
 			for (size_t i = 0; i < dim; i++){
 				if (data.indexes[i] < this->weightDim){
 					predict += weightVec[data.indexes[i]] * data.features[i];
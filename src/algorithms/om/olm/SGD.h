@@ -9,6 +9,12 @@
 #define HEADER_SOLM_SGD
 
 #include "OnlineLinearModel.h"
+#include "../StaticIterator.h"
+#include "../../../loss/HingeLoss.h"
+#include "../../../loss/LogisticLoss.h"
+#include "../../../loss/FastLogisticLoss.h"
+#include "../../../loss/SquareLoss.h"
+#include "../../../loss/SquaredHingeLoss.h"
 
 /**
 *  namespace: Batch and Online Classification
@@ -21,6 +27,8 @@ namespace BOC {
 
 	protected:
 		float(*pEta_time)(size_t t, float pt);
+		//l2 regularization
+		float lambda2;
 
 		/**
 		 * @Synopsis Constructors
@@ -29,6 +37,8 @@ namespace BOC {
 		SGD(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
 			OnlineLinearModel<FeatType, LabelType>(lossFunc, classNum) {
 			this->modelName = "SGD";
+			this->reuseGathered = true;
+			this->lambda2 = 0;
 		}
 
 		virtual ~SGD() {
@@ -38,10 +48,32 @@ namespace BOC {
 		 * @Synopsis inherited functions
 		 */
 	public:
+		/**
+		 * PrintModelSettings print the info of optimization algorithm
+		 */
+		virtual void PrintModelSettings() const {
+			OnlineLinearModel<FeatType, LabelType>::PrintModelSettings();
+			printf("\tl2 regularization: %g\n", this->lambda2);
+		}
+
+		/**
+		 * @Synopsis SetParameter set parameters for the learning model
+		 *
+		 * @Param param
+		 */
+		virtual void SetParameter(BOC::Params &param){
+			OnlineLinearModel<FeatType, LabelType>::SetParameter(param);
+			float val = param.FloatValue("-l2");
+			if (val >= 0) {
+				this->lambda2 = val;
+			}
+		}
+
 		/**
 		 * @Synopsis BeginTrain Reset the optimizer to the initialization status of training
 		 */
 		virtual void BeginTrain() {
+			INVALID_ARGUMENT_EXCEPTION(lambda2, this->lambda2 >= 0, "no smaller than 0");
 			OnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
 			if (this->power_t == 0.5)
@@ -54,6 +86,71 @@ namespace BOC {
 				this->pEta_time = pEta_general;
 		}
 
+		/**
+		 * @Synopsis IterateBC Iteration of online learning for binary classification
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted value of the current example
+		 *
+		 * @Returns  predicted class of the current example
+		 */
+		virtual int IterateBC(const DataPoint<FeatType, LabelType> &x, float* predict){
+			int ret = OnlineLinearModel<FeatType, LabelType>::IterateBC(x, predict);
+			this->DecayWeightVec(1);
+			return ret;
+		}
+
+		/**
+		 * @Synopsis IterateMC Iteration of online learning for multiclass classification
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values of the current example
+		 *
+		 * @Returns  predicted class of the current example
+		 */
+		virtual int IterateMC(const DataPoint<FeatType, LabelType> &x, float* predict){
+			int ret = OnlineLinearModel<FeatType, LabelType>::IterateMC(x, predict);
+			this->DecayWeightVec(1);
+			return ret;
+		}
+
+		/**
+		 * @Synopsis IterateBatch Iteration of online learning on a mini-batch
+		 */
+		virtual void IterateBatch(const DataPoint<FeatType, LabelType> *data, size_t num,
+			float* predicts, int* predictLabels){
+			OnlineLinearModel<FeatType, LabelType>::IterateBatch(data, num, predicts, predictLabels);
+			this->DecayWeightVec(num);
+		}
+
+		/**
+		 * @Synopsis IterateBCStatic Iteration of binary classification with the loss
+		 * function known at compile time, the same as IterateBC without virtual calls
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted value of the current example
+		 *
+		 * @Returns  predicted class of the current example
+		 */
+		template <typename LossType>
+		inline int IterateBCStatic(const DataPoint<FeatType, LabelType> &x, float* predict){
+			this->curIterNum++;
+			*predict = this->TrainPredictGather(*this->pWeightVecBC, x) * this->WeightScale(0);
+			int label = this->GetClassLabel(x);
+			float gt = LossType::Gradient(label, *predict);
+			if (gt != 0){
+				this->SGD<FeatType, LabelType>::UpdateWeightVec(x, &gt);
+			}
+			this->isGathered = false;
+			this->DecayWeightVec(1);
+			if (LossFunction<FeatType, LabelType>::Sign(*predict) != label){
+				return -label;
+			}
+			else{
+				return x.label;
+			}
+		}
+
 		/**
 		 * @Synopsis UpdateWeightVec Update the weight vector
 		 *
@@ -66,16 +163,69 @@ namespace BOC {
 			size_t featDim = x.indexes.size();
 
 			for (int k = 0; k < this->classfier_num; ++k){
-				s_array<float> &weightVec = this->weightMatrix[k];
-				for (size_t i = 0; i < featDim; i++) {
-					weightVec[x.indexes[i]] -= this->eta * gt_t[k] * x.features[i];
-				}
+				scaled_array<float> &weightVec = this->scaledWeights[k];
+				weightVec.add_sparse(-this->eta * gt_t[k], x.indexes.begin, x.features.begin, featDim,
+					x.is_strict, this->isGathered ? this->gatheredWeights.begin : NULL);
 				//update bias 
-				weightVec[0] -= this->eta * gt_t[k];
+				weightVec.add(0, -this->eta * gt_t[k]);
+			}
+		}
+
+		/**
+		 * @Synopsis IsBatchSupported SGD applies the summed gradients of a mini-batch
+		 */
+		virtual bool IsBatchSupported() const { return true; }
+
+	protected:
+		/**
+		 * @Synopsis UpdateWeightVecBatch apply the merged gradients of a mini-batch
+		 *
+		 * @Param grads merged sparse gradient for each classifier
+		 * @Param biasGrads accumulated gradient of bias for each classifier
+		 */
+		virtual void UpdateWeightVecBatch(const vector<DataPoint<FeatType, LabelType> > &grads, const float* biasGrads){
+			this->eta = this->eta0 / this->pEta_time(this->curIterNum, this->power_t);
+
+			for (int k = 0; k < this->classfier_num; ++k){
+				scaled_array<float> &weightVec = this->scaledWeights[k];
+				const DataPoint<FeatType, LabelType> &grad = grads[k];
+				weightVec.add_sparse(-this->eta, grad.indexes.begin, grad.features.begin, grad.indexes.size(),
+					grad.is_strict, NULL);
+				//update bias 
+				weightVec.add(0, -this->eta * biasGrads[k]);
+			}
+		}
+
+		/**
+		 * @Synopsis DecayWeightVec shrink the weights (except the bias) by the
+		 * l2 regularization, O(1) by changing the scale factor
+		 *
+		 * @Param num number of examples since the last decay
+		 */
+		inline void DecayWeightVec(size_t num){
+			if (this->lambda2 <= 0){
+				return;
+			}
+			float eta = this->eta0 / this->pEta_time(this->curIterNum, this->power_t);
+			float coeff = 1.f - eta * this->lambda2;
+			if (num > 1){
+				coeff = powf(coeff, (float)num);
+			}
+			for (int k = 0; k < this->classfier_num; ++k){
+				scaled_array<float> &weightVec = this->scaledWeights[k];
+				float bias = weightVec.get(0);
+				weightVec.multiply(coeff < 0 ? 0 : coeff);
+				weightVec.set(0, bias);
 			}
 		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(SGD, "Stochasitic Gradient Descent")
+
+	IMPLEMENT_STATIC_ITERATOR(SGD, HingeLoss, Hinge)
+	IMPLEMENT_STATIC_ITERATOR(SGD, LogisticLoss, Logistic)
+	IMPLEMENT_STATIC_ITERATOR(SGD, FastLogisticLoss, FastLogistic)
+	IMPLEMENT_STATIC_ITERATOR(SGD, SquareLoss, Square)
+	IMPLEMENT_STATIC_ITERATOR(SGD, SquaredHingeLoss, SquaredHinge)
 }
 #endif
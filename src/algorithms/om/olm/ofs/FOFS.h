@@ -26,6 +26,9 @@ namespace BOC {
 
 		float delta;
 		s_array<float> weightMatrixPNorm;
+		//p-norms scaled with the weights in binary classification, so that the
+		//order of the p-norms in the heap is kept when the weights are projected
+		scaled_array<float> scaledPNorm;
 
 		MinHeap<float> minHeap;
 
@@ -35,6 +38,7 @@ namespace BOC {
 			this->modelName = "FOFS";
 			this->delta = 0;
 			this->power_t = 0;
+			this->isTrackNorm = true;
 
 			this->weightMatrixPNorm.resize(this->weightDim);
 		}
@@ -81,6 +85,7 @@ namespace BOC {
 			this->power_t = 0;
 
 			this->weightMatrixPNorm.zeros();
+			this->scaledPNorm.attach(this->weightMatrixPNorm, false);
 			if (this->K > 0){
 				if (this->weightDim < this->K + 1)
 					this->UpdateModelDimention(this->K);
@@ -118,28 +123,39 @@ namespace BOC {
 		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t){
 			size_t featDim = x.indexes.size();
 
-			//update with sgd
+			//update with sgd, then project to the L2 ball, O(nnz) with the scaled weights
 			for (int k = 0; k < this->classfier_num; ++k){
-				s_array<float> &weightVec = this->weightMatrix[k];
-				for (size_t i = 0; i < featDim; i++) {
-					weightVec[x.indexes[i]] -= this->eta0 * gt_t[k] * x.features[i];
-				}
+				scaled_array<float> &weightVec = this->scaledWeights[k];
+				weightVec.add_sparse(-this->eta0 * gt_t[k], x.indexes.begin, x.features.begin, featDim, x.is_strict, NULL);
 				//update bias 
-				weightVec[0] -= this->eta0 * gt_t[k];
-
-				float w_norm = 0;
-				for (IndexType i = 0; i < this->weightDim; i++)
-					w_norm += weightVec[i] * weightVec[i];
+				weightVec.add(0, -this->eta0 * gt_t[k]);
 
-				float coeff = this->norm_coeff / sqrtf(w_norm);
+				float coeff = this->norm_coeff / sqrtf((float)weightVec.norm2());
 				if (coeff < 1){
-					for (IndexType i = 0; i < this->weightDim; i++){
-						weightVec[i] *= coeff;
+					weightVec.multiply(coeff);
+					if (this->classfier_num == 1){
+						this->scaledPNorm.multiply(coeff * coeff);
 					}
 				}
 			}
 
-			if (this->K > 0){
+			if (this->K > 0 && this->classfier_num == 1){
+				//only the p-norms of the touched features change, O(nnz log K)
+				scaled_array<float> &weightVec = this->scaledWeights[0];
+				IndexType ret_id;
+				for (size_t i = 0; i < featDim; ++i){
+					IndexType index = x.indexes[i];
+					float w = weightVec.get(index);
+					this->scaledPNorm.set(index, w * w);
+					if (this->minHeap.UpdateHeap(index - 1, ret_id) == true){
+						weightVec.set(ret_id + 1, 0);
+						this->scaledPNorm.set(ret_id + 1, 0);
+					}
+				}
+			}
+			else if (this->K > 0){
+				//the weight vectors of the classes are scaled differently, so
+				//the p-norms of all the features are recomputed
 
 				//update pnorm
 				for (size_t i = 0; i < this->weightDim; ++i){
@@ -147,9 +163,10 @@ namespace BOC {
 				}
 
 				for (int k = 0; k < this->classfier_num; ++k){
-					s_array<float> &weightVec = this->weightMatrix[k];
+					const scaled_array<float> &weightVec = this->scaledWeights[k];
 					for (size_t i = 0; i < this->weightDim; ++i){
-						this->weightMatrixPNorm[i] += weightVec[i] * weightVec[i];
+						float w = weightVec.get(i);
+						this->weightMatrixPNorm[i] += w * w;
 					}
 				}
 
@@ -159,13 +176,56 @@ namespace BOC {
 				for (IndexType i = 0; i < this->weightDim - 1; i++){
 					if (this->minHeap.UpdateHeap(i, ret_id) == true){
 						for (int k = 0; k < this->classfier_num; ++k){
-							(this->weightMatrix[k])[ret_id + 1] = 0;
+							this->scaledWeights[k].set(ret_id + 1, 0);
 						}
 						this->weightMatrixPNorm[ret_id + 1] = 0;
 					}
 				}
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the norms of the weights and the heap of
+		 * the selected features to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_value(os, this->w_norm);
+			write_value(os, this->norm_coeff);
+			write_array(os, this->weightMatrixPNorm);
+			this->scaledPNorm.save(os);
+			this->minHeap.SaveState(os);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the norms of the weights and the heap of
+		 * the selected features from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			reader.read_value(this->w_norm);
+			reader.read_value(this->norm_coeff);
+			if (reader.read_array(this->weightMatrixPNorm) == false){
+				return false;
+			}
+			this->scaledPNorm.attach(this->weightMatrixPNorm, false);
+			return this->scaledPNorm.load(reader) &&
+				this->minHeap.LoadState(reader, this->weightMatrixPNorm.begin + 1);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(FOFS, "First Order Online Feature Selection")
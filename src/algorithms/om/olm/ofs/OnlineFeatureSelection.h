@@ -62,7 +62,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelConfig(std::ofstream &os) {
+		virtual bool SaveModelConfig(std::ostream &os) {
 			OnlineLinearModel<FeatType, LabelType>::SaveModelConfig(os);
 
 			//select k features
@@ -78,7 +78,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelConfig(std::ifstream &is) {
+		virtual bool LoadModelConfig(std::istream &is) {
 			OnlineLinearModel<FeatType, LabelType>::LoadModelConfig(is);
 			//select k features
 			string line;
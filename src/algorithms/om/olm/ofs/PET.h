@@ -102,41 +102,68 @@ namespace BOC {
 			//update with sgd
 			for (int k = 0; k < this->classfier_num; ++k){
 				s_array<float> &weightVec = this->weightMatrix[k];
-				for (size_t i = 0; i < featDim; i++) {
-					weightVec[x.indexes[i]] -= this->eta * gt_t[k] * x.features[i];
-				}
+				sparse_axpy(-this->eta * gt_t[k], x.indexes.begin, x.features.begin, featDim,
+					x.is_strict, NULL, weightVec.begin);
 				//update bias 
 				weightVec[0] -= this->eta * gt_t[k];
 			}
 
 
-			//update pnorm
+			//update pnorm and truncate, only the touched features change,
+			//O(nnz log K) with the incremental heap updates
+			IndexType ret_id;
 			for (size_t i = 0; i < featDim; ++i){
-				this->weightMatrixPNorm[x.indexes[i]] = 0;
-			}
-
-			for (int k = 0; k < this->classfier_num; ++k){
-				s_array<float> &weightVec = this->weightMatrix[k];
-				for (size_t i = 0; i < featDim; ++i){
-					this->weightMatrixPNorm[x.indexes[i]] += weightVec[x.indexes[i]] * weightVec[x.indexes[i]];
+				IndexType index = x.indexes[i];
+				float pnorm = 0;
+				for (int k = 0; k < this->classfier_num; ++k){
+					float w = this->weightMatrix[k][index];
+					pnorm += w * w;
 				}
-			}
+				this->weightMatrixPNorm[index] = pnorm;
 
-			if (this->K > 0){
-				this->minHeap.BuildHeap();
-				//truncate
-				IndexType ret_id;
-				for (IndexType i = 0; i < this->weightDim - 1; i++){
-					if (this->minHeap.UpdateHeap(i, ret_id) == true){
-						for (int k = 0; k < this->classfier_num; ++k){
-							(this->weightMatrix[k])[ret_id + 1] = 0;
-						}
-						this->weightMatrixPNorm[ret_id + 1] = 0;
+				if (this->K > 0 && this->minHeap.UpdateHeap(index - 1, ret_id) == true){
+					for (int k = 0; k < this->classfier_num; ++k){
+						(this->weightMatrix[k])[ret_id + 1] = 0;
 					}
+					this->weightMatrixPNorm[ret_id + 1] = 0;
 				}
 			}
 		}
 #pragma endregion Train Related
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the norms of the weights and the heap of
+		 * the selected features to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->weightMatrixPNorm);
+			this->minHeap.SaveState(os);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the norms of the weights and the heap of
+		 * the selected features from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return reader.read_array(this->weightMatrixPNorm) &&
+				this->minHeap.LoadState(reader, this->weightMatrixPNorm.begin + 1);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(PET, "Perceptron with Truncation")
@@ -236,6 +236,40 @@ namespace BOC {
 		}
 #pragma endregion Train Related
 
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the variances and the heap of the
+		 * selected features to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->sigmaWMatrix);
+			write_array(os, this->sigmaWSum);
+			this->heap.SaveState(os);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the variances and the heap of the
+		 * selected features from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (OnlineFeatureSelection<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return reader.read_array(this->sigmaWMatrix) && reader.read_array(this->sigmaWSum) &&
+				this->heap.LoadState(reader, this->sigmaWSum.begin + 1);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(SOFS, "Second Order Online Feature Selection")
@@ -26,6 +26,13 @@ namespace BOC{
 
             SOLModelInfo<FeatType,LabelType>::GetModelInfo(info);
             OFSModelInfo<FeatType, LabelType>::GetModelInfo(info);
+
+			info.append("\nSpecialized Training Loops:");
+			APPEND_INFO(info, SGD_Hinge_Iterator, FeatType, LabelType);
+			APPEND_INFO(info, SGD_Logistic_Iterator, FeatType, LabelType);
+			APPEND_INFO(info, SGD_FastLogistic_Iterator, FeatType, LabelType);
+			APPEND_INFO(info, SGD_Square_Iterator, FeatType, LabelType);
+			APPEND_INFO(info, SGD_SquaredHinge_Iterator, FeatType, LabelType);
 		}
 	};
 }
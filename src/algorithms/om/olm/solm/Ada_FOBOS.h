@@ -26,8 +26,11 @@ namespace BOC {
 
 	protected:
 		float delta;
+		//time stamp of the last truncation, shared by the classifiers
 		s_array<size_t> timeStamp;
-		s_array<float> s;
+		//root of the sum of squared gradients of each classifier
+		vector<s_array<float> > sMatrix;
+		s_array<float>& s;
 		s_array<float> u_t;
 
 		/**
@@ -35,11 +38,14 @@ namespace BOC {
 		 */
 	public:
 		Ada_FOBOS(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
-			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
+			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum),
+			sMatrix(this->classfier_num), s(sMatrix[0]){
 			this->modelName = "Ada-FOBOS";
 			this->delta = init_delta;
 			this->timeStamp.resize(this->weightDim);
-			this->s.resize(this->weightDim);
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->sMatrix[k].resize(this->weightDim);
+			}
 			this->u_t.resize(this->weightDim);
 		}
 
@@ -80,7 +86,9 @@ namespace BOC {
 
 			//reset time stamp
 			this->timeStamp.zeros();
-			this->s.zeros();
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->sMatrix[k].zeros();
+			}
 			this->u_t.zeros();
 		}
 
@@ -90,11 +98,15 @@ namespace BOC {
 		virtual void EndTrain() {
 			size_t iterNum = this->curIterNum + 1;
 			float alpha = 0;
-			for (IndexType index_i = 1; index_i < this->weightDim; index_i++) {
-				//update s[i]
-				float Ht0i = this->delta + s[index_i];
-				alpha = this->lambda * this->eta0 * (iterNum - this->timeStamp[index_i]) / Ht0i;
-				this->weightVec[index_i] = trunc_weight(this->weightVec[index_i], alpha);
+			for (int k = 0; k < this->classfier_num; ++k){
+				s_array<float>& weightVec = this->weightMatrix[k];
+				s_array<float>& s = this->sMatrix[k];
+				for (IndexType index_i = 1; index_i < this->weightDim; index_i++) {
+					//update s[i]
+					float Ht0i = this->delta + s[index_i];
+					alpha = this->lambda * this->eta0 * (iterNum - this->timeStamp[index_i]) / Ht0i;
+					weightVec[index_i] = trunc_weight(weightVec[index_i], alpha);
+				}
 			}
 
 			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
@@ -148,6 +160,59 @@ namespace BOC {
 			return y;
 		}
 
+		/**
+		 * @Synopsis PredictMC predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = this->TrainPredict(this->weightMatrix[k], x);
+			}
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec update the weights of each classifier, the
+		 * lazy truncation is done once for all the classifiers
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			if (gt_t[(int)x.label] == 0){
+				return;
+			}
+			float alpha = this->eta0 * this->lambda;
+			size_t featDim = x.indexes.size();
+			for (size_t i = 0; i < featDim; i++) {
+				IndexType index_i = x.indexes[i];
+				size_t stepK = this->curIterNum - this->timeStamp[index_i];
+				for (int k = 0; k < this->classfier_num; ++k){
+					s_array<float>& weightVec = this->weightMatrix[k];
+					s_array<float>& s = this->sMatrix[k];
+					float gt_i = gt_t[k] * x.features[i];
+
+					float Ht0i = this->delta + s[index_i];
+					if (gt_i != 0){
+						s[index_i] = sqrt(s[index_i] * s[index_i] + gt_i * gt_i);
+						weightVec[index_i] -= this->eta0 * gt_i / (this->delta + s[index_i]);
+					}
+					weightVec[index_i] = trunc_weight(weightVec[index_i], alpha * stepK / Ht0i);
+				}
+				//update the time stamp
+				this->timeStamp[index_i] = this->curIterNum;
+			}
+
+			//bias term
+			for (int k = 0; k < this->classfier_num; ++k){
+				s_array<float>& s = this->sMatrix[k];
+				s[0] = sqrt(s[0] * s[0] + gt_t[k] * gt_t[k]);
+				this->weightMatrix[k][0] -= this->eta0 * gt_t[k] / (this->delta + s[0]);
+			}
+		}
+
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -163,10 +228,12 @@ namespace BOC {
 				this->timeStamp.zeros(this->timeStamp.begin + this->weightDim,
 					this->timeStamp.end);
 
-				this->s.resize(new_dim + 1);
-				//set the rest to zero
-				this->s.zeros(this->s.begin + this->weightDim,
-					this->s.end);
+				for (int k = 0; k < this->classfier_num; ++k){
+					s_array<float>& s = this->sMatrix[k];
+					s.resize(new_dim + 1);
+					//set the rest to zero
+					s.zeros(s.begin + this->weightDim, s.end);
+				}
 
 				this->u_t.resize(new_dim + 1);
 				//set the rest to zero
@@ -176,6 +243,39 @@ namespace BOC {
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the time stamps and the accumulated
+		 * squared gradients to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->timeStamp);
+			write_array(os, this->sMatrix);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the time stamps and the accumulated
+		 * squared gradients from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return reader.read_array(this->timeStamp) && reader.read_array(this->sMatrix);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(Ada_FOBOS, "Adaptive FOBOS")
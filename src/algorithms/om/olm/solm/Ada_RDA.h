@@ -27,15 +27,18 @@ namespace BOC {
 
 	protected:
 		float delta;
-		s_array<float> s;
-		s_array<float> u_t;
+		//per-feature states: weight, sum of squared gradients (s) and sum of
+		//gradients (u_t), of each class for multiclass
+		enum { STATE_W = 0, STATE_S = 1, STATE_U = 2 };
+		feature_state<3> state;
+		//the states in bf16, only one of state and state16 is used
+		feature_state<3, bf16_field> state16;
 	public:
 		Ada_RDA(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
 			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
 			this->modelName = "Ada-RDA";
 			this->delta = init_delta;
-			this->s.resize(this->weightDim);
-			this->u_t.resize(this->weightDim);
+			this->state.resize(this->weightDim);
 		}
 
 		virtual ~Ada_RDA() {
@@ -51,6 +54,8 @@ namespace BOC {
 		virtual void PrintModelSettings() const {
 			SparseOnlineLinearModel<FeatType, LabelType>::PrintModelSettings();
 			printf("\tdelta : %g\n", this->delta);
+			printf("\tstate layout : %s\n", this->stateLayout.c_str());
+			printf("\tstate precision : %s\n", this->statePrecision.c_str());
 		}
 
 		/**
@@ -73,11 +78,40 @@ namespace BOC {
 			INVALID_ARGUMENT_EXCEPTION(delta, this->delta >= 0, "no smaller than 0");
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
-			//reset time stamp
-			this->s.zeros();
-			this->u_t.zeros();
+			//reset the states
+			if (this->isHalfPrecision == true)
+				this->InitState(this->state16);
+			else
+				this->InitState(this->state);
 		}
 
+		/**
+		 * @Synopsis EndTrain called when a train ends
+		 */
+		virtual void EndTrain() {
+			if (this->isHalfPrecision == true)
+				this->CopyStateWeights(this->state16, STATE_W);
+			else
+				this->CopyStateWeights(this->state, STATE_W);
+			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
+		}
+
+		/**
+		 * @Synopsis PrefetchWeights prefetch the states of an example
+		 *
+		 * @Param x the example
+		 */
+		virtual void PrefetchWeights(const DataPoint<FeatType, LabelType> &x) const {
+			for (size_t i = 0; i < x.indexes.size(); ++i){
+				if (this->isHalfPrecision == true)
+					this->state16.prefetch(x.indexes[i]);
+				else
+					this->state.prefetch(x.indexes[i]);
+			}
+		}
+
+		virtual bool IsHalfPrecisionSupported() const { return true; }
+
 		/**
 		 * @Synopsis Iterate Iteration of online learning
 		 *
@@ -86,22 +120,68 @@ namespace BOC {
 		 * @Returns  prediction of the current example
 		 */
 		virtual float Iterate(const DataPoint<FeatType, LabelType> &x) {
+			if (this->isHalfPrecision == true)
+				return this->IterateState(this->state16, x);
+			else
+				return this->IterateState(this->state, x);
+		}
+
+		/**
+		 * @Synopsis PredictMC obtain the weights of the touched features and
+		 * predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			if (this->isHalfPrecision == true)
+				this->PredictStateMC(this->state16, x, predict);
+			else
+				this->PredictStateMC(this->state, x, predict);
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec accumulate the gradients of each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			if (this->isHalfPrecision == true)
+				this->UpdateStateMC(this->state16, x, gt_t);
+			else
+				this->UpdateStateMC(this->state, x, gt_t);
+		}
+
+	protected:
+		/**
+		 * @Synopsis IterateState Iteration of online learning, the states are
+		 * computed in float and stored in the precision of StateType
+		 *
+		 * @Param state per-feature states
+		 * @Param x current input data example
+		 *
+		 * @Returns  prediction of the current example
+		 */
+		template <typename StateType>
+		inline float IterateState(StateType &state, const DataPoint<FeatType, LabelType> &x) {
 			this->curIterNum++;
 			size_t featDim = x.indexes.size();
 			IndexType index_i = 0;
 
-			//obtain w_t
+			//obtain w_t and predict, the weights are kept with the states
+			float y = 0;
 			for (size_t i = 0; i < featDim; i++) {
 				index_i = x.indexes[i];
 				//lazy update
-				//update s[i]
-				float Htii = this->delta + sqrtf(s[index_i]);
-				this->weightVec[index_i] = -this->eta0 / Htii *
-					trunc_weight(u_t[index_i], this->lambda * (this->curIterNum - 1));
+				float Htii = this->delta + sqrtf(state.get(index_i, STATE_S));
+				float w = -this->eta0 / Htii *
+					trunc_weight(state.get(index_i, STATE_U), this->lambda * (this->curIterNum - 1));
+				state.set(index_i, STATE_W, w);
+				y += w * x.features[i];
 			}
+			y += state.get(0, STATE_W);
 
-			//predict 
-			float y = this->TrainPredict(this->weightVec,x);
 			//get gradient
 			float gt = 0;
 			this->lossFunc->GetGradient(x.label, &y, &gt);
@@ -112,18 +192,89 @@ namespace BOC {
 					index_i = x.indexes[i];
 					gt_i = gt * x.features[i];
 
-					this->s[index_i] += gt_i * gt_i;
-					this->u_t[index_i] += gt_i;
+					state.set(index_i, STATE_S, state.get(index_i, STATE_S) + gt_i * gt_i);
+					state.set(index_i, STATE_U, state.get(index_i, STATE_U) + gt_i);
 				}
 				//bias term
-				this->s[0] += gt * gt;
-				this->u_t[0] += gt;
-				float Htii = this->delta + sqrtf(s[0]);
-				this->weightVec[0] = -u_t[0] * this->eta0 / Htii;
+				float s_0 = state.get(0, STATE_S) + gt * gt;
+				float u_0 = state.get(0, STATE_U) + gt;
+				state.set(0, STATE_S, s_0);
+				state.set(0, STATE_U, u_0);
+				float Htii = this->delta + sqrtf(s_0);
+				state.set(0, STATE_W, -u_0 * this->eta0 / Htii);
 			}
 			return y;
 		}
 
+		template <typename StateType>
+		inline void PredictStateMC(StateType &state, const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			size_t featDim = x.indexes.size();
+			float lambda_t = this->lambda * (this->curIterNum - 1);
+
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = state.get(0, STATE_W, k);
+			}
+			//obtain w_t and predict
+			for (size_t i = 0; i < featDim; i++) {
+				IndexType index_i = x.indexes[i];
+				for (int k = 0; k < this->classfier_num; ++k){
+					float Htii = this->delta + sqrtf(state.get(index_i, STATE_S, k));
+					float w = -this->eta0 / Htii * trunc_weight(state.get(index_i, STATE_U, k), lambda_t);
+					state.set(index_i, STATE_W, k, w);
+					predict[k] += w * x.features[i];
+				}
+			}
+		}
+
+		template <typename StateType>
+		inline void UpdateStateMC(StateType &state, const DataPoint<FeatType, LabelType> &x, const float* gt_t) {
+			size_t featDim = x.indexes.size();
+			for (int k = 0; k < this->classfier_num; ++k){
+				float gt = gt_t[k];
+				if (gt == 0){
+					continue;
+				}
+				for (size_t i = 0; i < featDim; i++) {
+					IndexType index_i = x.indexes[i];
+					float gt_i = gt * x.features[i];
+					state.set(index_i, STATE_S, k, state.get(index_i, STATE_S, k) + gt_i * gt_i);
+					state.set(index_i, STATE_U, k, state.get(index_i, STATE_U, k) + gt_i);
+				}
+				//bias term
+				float s_0 = state.get(0, STATE_S, k) + gt * gt;
+				float u_0 = state.get(0, STATE_U, k) + gt;
+				state.set(0, STATE_S, k, s_0);
+				state.set(0, STATE_U, k, u_0);
+				float Htii = this->delta + sqrtf(s_0);
+				state.set(0, STATE_W, k, -u_0 * this->eta0 / Htii);
+			}
+		}
+
+		/**
+		 * @Synopsis StateWeight the current weight of a feature kept in the
+		 * states, with the pending lazy update applied
+		 *
+		 * @Param i index of the feature
+		 * @Param k index of the classifier
+		 */
+		virtual float StateWeight(IndexType i, int k) const {
+			if (this->isHalfPrecision == true)
+				return this->StateWeight(this->state16, i, k);
+			else
+				return this->StateWeight(this->state, i, k);
+		}
+
+		template <typename StateType>
+		inline float StateWeight(const StateType &state, IndexType i, int k) const {
+			if (i == 0){
+				return state.get(0, STATE_W, k);
+			}
+			float Htii = this->delta + sqrtf(state.get(i, STATE_S, k));
+			return -this->eta0 / Htii * trunc_weight(state.get(i, STATE_U, k), this->lambda * this->curIterNum);
+		}
+
+	public:
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -134,19 +285,53 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->s.resize(new_dim + 1);
-				//set the rest to zero
-				this->s.zeros(this->s.begin + this->weightDim,
-					this->s.end);
-
-				this->u_t.resize(new_dim + 1);
-				//set the rest to zero
-				this->u_t.zeros(this->u_t.begin + this->weightDim,
-					this->u_t.end);
+				if (this->isHalfPrecision == true)
+					this->state16.resize(new_dim + 1);
+				else
+					this->state.resize(new_dim + 1);
 
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the per-feature states to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			if (this->isHalfPrecision == true){
+				this->state16.save(os);
+			}
+			else{
+				this->state.save(os);
+			}
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the per-feature states from the
+		 * checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			if (this->isHalfPrecision == true){
+				return this->state16.load(reader);
+			}
+			return this->state.load(reader);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(Ada_RDA, "Adaptive RDA")
@@ -9,6 +9,7 @@
 
 #include "SparseOnlineLinearModel.h"
 #include "../../../../loss/SquaredHingeLoss.h"
+#include "../../../../loss/MaxScoreSquaredHingeLoss.h"
 
 /**
 *  namespace: Batch and Online Classification
@@ -21,8 +22,12 @@ namespace BOC {
 
 	protected:
 		float r;
-		s_array<float> sigma_w;
-		s_array<float> u_t;
+		//per-feature states: weight, variance (sigma_w) and sum of gradients
+		//(u_t), of each class for multiclass
+		enum { STATE_W = 0, STATE_SIGMA = 1, STATE_U = 2 };
+		feature_state<3> state;
+		//the states in bf16, only one of state and state16 is used
+		feature_state<3, bf16_field> state16;
 		float gravity;
 
 	public:
@@ -30,9 +35,11 @@ namespace BOC {
 			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
 			this->modelName = "CW-RDA";
 			this->r = init_r;
-			this->u_t.resize(this->weightDim);
-			this->sigma_w.resize(this->weightDim);
-			this->lossFunc = new SquaredHingeLoss < FeatType, LabelType > ;
+			this->state.resize(this->weightDim);
+			if (this->classfier_num == 1)
+				this->lossFunc = new SquaredHingeLoss < FeatType, LabelType > ;
+			else
+				this->lossFunc = new MaxScoreSquaredHingeLoss < FeatType, LabelType > ;
 		}
 
 		virtual ~CW_RDA(){
@@ -52,6 +59,8 @@ namespace BOC {
 		virtual void PrintModelSettings() const {
 			SparseOnlineLinearModel<FeatType, LabelType>::PrintModelSettings();
 			printf("\tr:\t%g\n", this->r);
+			printf("\tstate layout:\t%s\n", this->stateLayout.c_str());
+			printf("\tstate precision:\t%s\n", this->statePrecision.c_str());
 		}
 
 		/**
@@ -73,11 +82,44 @@ namespace BOC {
 		virtual void BeginTrain() {
 			INVALID_ARGUMENT_EXCEPTION(r, this->r >= 0, "no smaller than 0");
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
-			this->u_t.zeros();
-			this->sigma_w.set_value(1);
+			if (this->isHalfPrecision == true){
+				this->InitState(this->state16);
+				this->state16.set_real(STATE_SIGMA, 1);
+			}
+			else{
+				this->InitState(this->state);
+				this->state.set_real(STATE_SIGMA, 1);
+			}
 			this->gravity = 0;
 		}
 
+		/**
+		 * @Synopsis EndTrain called when a train ends
+		 */
+		virtual void EndTrain() {
+			if (this->isHalfPrecision == true)
+				this->CopyStateWeights(this->state16, STATE_W);
+			else
+				this->CopyStateWeights(this->state, STATE_W);
+			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
+		}
+
+		/**
+		 * @Synopsis PrefetchWeights prefetch the states of an example
+		 *
+		 * @Param x the example
+		 */
+		virtual void PrefetchWeights(const DataPoint<FeatType, LabelType> &x) const {
+			for (size_t i = 0; i < x.indexes.size(); ++i){
+				if (this->isHalfPrecision == true)
+					this->state16.prefetch(x.indexes[i]);
+				else
+					this->state.prefetch(x.indexes[i]);
+			}
+		}
+
+		virtual bool IsHalfPrecisionSupported() const { return true; }
+
 		/**
 		 * @Synopsis Iterate Iteration of online learning
 		 *
@@ -86,19 +128,67 @@ namespace BOC {
 		 * @Returns  prediction of the current example
 		 */
 		virtual float Iterate(const DataPoint<FeatType, LabelType> &x) {
+			if (this->isHalfPrecision == true)
+				return this->IterateState(this->state16, x);
+			else
+				return this->IterateState(this->state, x);
+		}
+
+		/**
+		 * @Synopsis PredictMC obtain the weights of the touched features and
+		 * predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			if (this->isHalfPrecision == true)
+				this->PredictStateMC(this->state16, x, predict);
+			else
+				this->PredictStateMC(this->state, x, predict);
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec update each classifier, the learning rate
+		 * and the L1 gravity are shared by the classifiers
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			if (this->isHalfPrecision == true)
+				this->UpdateStateMC(this->state16, x, gt_t);
+			else
+				this->UpdateStateMC(this->state, x, gt_t);
+		}
+
+	protected:
+		/**
+		 * @Synopsis IterateState Iteration of online learning, the states are
+		 * computed in float and stored in the precision of StateType
+		 *
+		 * @Param state per-feature states
+		 * @Param x current input data example
+		 *
+		 * @Returns  prediction of the current example
+		 */
+		template <typename StateType>
+		inline float IterateState(StateType &state, const DataPoint<FeatType, LabelType> &x) {
+			this->curIterNum++;
 			IndexType* p_index = x.indexes.begin;
 			float* p_feat = x.features.begin;
-			//obtain w_t
+			//obtain w_t and predict, the weights are kept with the states
+			float y = 0;
 			while (p_index != x.indexes.end){
 				//lazy update
-				//this->weightVec[*p_index] = -sqrtf(this->sigma_w[*p_index]) *
-				this->weightVec[*p_index] = -sqrtf(this->sigma_w[*p_index]) *
-					trunc_weight(u_t[*p_index], gravity);
-				p_index++;
+				float w = -sqrtf(state.get(*p_index, STATE_SIGMA)) *
+					trunc_weight(state.get(*p_index, STATE_U), gravity);
+				state.set(*p_index, STATE_W, w);
+				y += w * (*p_feat);
+				p_index++; p_feat++;
 			}
+			y += state.get(0, STATE_W);
 
-			//predict 
-			float y = this->TrainPredict(this->weightVec, x);
 			//get gradient
 			float gt = 0;
 			this->lossFunc->GetGradient(x.label, &y, &gt);
@@ -109,10 +199,11 @@ namespace BOC {
 				p_index = x.indexes.begin;
 				p_feat = x.features.begin;
 				while (p_index != x.indexes.end){
-					temp_sum = (*p_feat) * (*p_feat) * this->sigma_w[*p_index];
+					float sigma_w = state.get(*p_index, STATE_SIGMA);
+					temp_sum = (*p_feat) * (*p_feat) * sigma_w;
 					this->eta += temp_sum;
 					//update sigma_w
-					this->sigma_w[*p_index] *= this->r / (this->r + temp_sum);
+					state.set(*p_index, STATE_SIGMA, sigma_w * this->r / (this->r + temp_sum));
 					p_index++; p_feat++;
 				}
 
@@ -123,17 +214,105 @@ namespace BOC {
 				p_index = x.indexes.begin;
 				p_feat = x.features.begin;
 				while (p_index != x.indexes.end){
-					this->u_t[*p_index++] += gt * (*p_feat++);
+					state.set(*p_index, STATE_U, state.get(*p_index, STATE_U) + gt * (*p_feat));
+					p_index++; p_feat++;
 				}
 
 				//bias term
-				this->u_t[0] += gt;
-				this->weightVec[0] = -u_t[0] * sqrtf(this->sigma_w[0]);
-				this->sigma_w[0] *= this->r / (this->r + this->sigma_w[0]);
+				float sigma_b = state.get(0, STATE_SIGMA);
+				float u_b = state.get(0, STATE_U) + gt;
+				state.set(0, STATE_U, u_b);
+				state.set(0, STATE_W, -u_b * sqrtf(sigma_b));
+				state.set(0, STATE_SIGMA, sigma_b * this->r / (this->r + sigma_b));
 			}
 			return y;
 		}
 
+		template <typename StateType>
+		inline void PredictStateMC(StateType &state, const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			size_t featDim = x.indexes.size();
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = state.get(0, STATE_W, k);
+			}
+			//obtain w_t and predict
+			for (size_t i = 0; i < featDim; i++) {
+				IndexType index_i = x.indexes[i];
+				for (int k = 0; k < this->classfier_num; ++k){
+					float w = -sqrtf(state.get(index_i, STATE_SIGMA, k)) *
+						trunc_weight(state.get(index_i, STATE_U, k), gravity);
+					state.set(index_i, STATE_W, k, w);
+					predict[k] += w * x.features[i];
+				}
+			}
+		}
+
+		template <typename StateType>
+		inline void UpdateStateMC(StateType &state, const DataPoint<FeatType, LabelType> &x, const float* gt_t) {
+			if (gt_t[(int)x.label] == 0){
+				return;
+			}
+			size_t featDim = x.indexes.size();
+			//calculate learning rate with the variances of the updated classifiers
+			this->eta = this->r;
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (gt_t[k] == 0){
+					continue;
+				}
+				for (size_t i = 0; i < featDim; i++) {
+					IndexType index_i = x.indexes[i];
+					float sigma_w = state.get(index_i, STATE_SIGMA, k);
+					float temp_sum = x.features[i] * x.features[i] * sigma_w;
+					this->eta += temp_sum;
+					//update sigma_w
+					state.set(index_i, STATE_SIGMA, k, sigma_w * this->r / (this->r + temp_sum));
+				}
+			}
+			this->eta = 0.5f / this->eta;
+			gravity += this->lambda * this->eta;
+
+			//update
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (gt_t[k] == 0){
+					continue;
+				}
+				float gt = gt_t[k] * this->eta;
+				for (size_t i = 0; i < featDim; i++) {
+					IndexType index_i = x.indexes[i];
+					state.set(index_i, STATE_U, k, state.get(index_i, STATE_U, k) + gt * x.features[i]);
+				}
+				//bias term
+				float sigma_b = state.get(0, STATE_SIGMA, k);
+				float u_b = state.get(0, STATE_U, k) + gt;
+				state.set(0, STATE_U, k, u_b);
+				state.set(0, STATE_W, k, -u_b * sqrtf(sigma_b));
+				state.set(0, STATE_SIGMA, k, sigma_b * this->r / (this->r + sigma_b));
+			}
+		}
+
+		/**
+		 * @Synopsis StateWeight the current weight of a feature kept in the
+		 * states, with the pending lazy update applied
+		 *
+		 * @Param i index of the feature
+		 * @Param k index of the classifier
+		 */
+		virtual float StateWeight(IndexType i, int k) const {
+			if (this->isHalfPrecision == true)
+				return this->StateWeight(this->state16, i, k);
+			else
+				return this->StateWeight(this->state, i, k);
+		}
+
+		template <typename StateType>
+		inline float StateWeight(const StateType &state, IndexType i, int k) const {
+			if (i == 0){
+				return state.get(0, STATE_W, k);
+			}
+			return -sqrtf(state.get(i, STATE_SIGMA, k)) * trunc_weight(state.get(i, STATE_U, k), this->gravity);
+		}
+
+	public:
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -144,19 +323,69 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->sigma_w.resize(new_dim + 1);
-				//set the rest to one
-				this->sigma_w.set_value(this->sigma_w.begin + this->weightDim,
-					this->sigma_w.end, 1);
-
-				this->u_t.resize(new_dim + 1);
-				//set the rest to zero
-				this->u_t.zeros(this->u_t.begin + this->weightDim,
-					this->u_t.end);
+				//set sigma_w of the new features to one
+				if (this->isHalfPrecision == true){
+					this->state16.resize(new_dim + 1);
+					for (IndexType i = this->weightDim; i <= new_dim; ++i){
+						for (int k = 0; k < this->classfier_num; ++k){
+							this->state16.set(i, STATE_SIGMA, k, 1);
+						}
+					}
+				}
+				else{
+					this->state.resize(new_dim + 1);
+					for (IndexType i = this->weightDim; i <= new_dim; ++i){
+						for (int k = 0; k < this->classfier_num; ++k){
+							this->state.set(i, STATE_SIGMA, k, 1);
+						}
+					}
+				}
 
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the per-feature states and the gravity
+		 * to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_value(os, this->gravity);
+			if (this->isHalfPrecision == true){
+				this->state16.save(os);
+			}
+			else{
+				this->state.save(os);
+			}
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the per-feature states and the gravity
+		 * from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			reader.read_value(this->gravity);
+			if (this->isHalfPrecision == true){
+				return this->state16.load(reader);
+			}
+			return this->state.load(reader);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(CW_RDA, "Confidence Weighted RDA")
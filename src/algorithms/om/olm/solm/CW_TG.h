@@ -13,6 +13,7 @@ of weight vectors." Machine Learning (2009): 1-33.
 
 #include "SparseOnlineLinearModel.h"
 #include "../../../../loss/SquaredHingeLoss.h"
+#include "../../../../loss/MaxScoreSquaredHingeLoss.h"
 
 /**
 *  namespace: Batch and Online Classification
@@ -25,7 +26,10 @@ namespace BOC {
 
 	protected:
 		float r;
-		s_array<float> sigma_w;
+		//variance of the weights of each classifier
+		vector<s_array<float> > sigmaWMatrix;
+		s_array<float>& sigma_w;
+		//time stamp of the last truncation, shared by the classifiers
 		s_array<size_t> timeStamp;
 		s_array<float> sum_rate;
 
@@ -33,12 +37,18 @@ namespace BOC {
 
 	public:
 		CW_TG(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
-			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
+			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum),
+			sigmaWMatrix(this->classfier_num), sigma_w(sigmaWMatrix[0]){
 			this->modelName = "Cw-TG";
 			this->r = init_r;
-			this->sigma_w.resize(this->weightDim);
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->sigmaWMatrix[k].resize(this->weightDim);
+			}
 			this->timeStamp.resize(this->weightDim);
-			this->lossFunc = new SquaredHingeLoss < FeatType, LabelType > ;
+			if (this->classfier_num == 1)
+				this->lossFunc = new SquaredHingeLoss < FeatType, LabelType > ;
+			else
+				this->lossFunc = new MaxScoreSquaredHingeLoss < FeatType, LabelType > ;
 		}
 		virtual ~CW_TG(){
 			if (this->lossFunc != NULL){
@@ -80,7 +90,9 @@ namespace BOC {
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
 			this->timeStamp.zeros();
-			this->sigma_w.set_value(1);
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->sigmaWMatrix[k].set_value(1);
+			}
 			this->sum_rate.push_back(0);
 			this->iter_num = 1; //force to begin from 1, as sum_rate depends on this value
 		}
@@ -98,8 +110,10 @@ namespace BOC {
 				//gravity = stepK * this->lambda * this->beta_t / 2.f;
 
 				//this->timeStamp[index_i] = this->curIterNum;
-				this->weightVec[index_i] = trunc_weight(this->weightVec[index_i],
-					gravity *(this->sigma_w[index_i]));
+				for (int k = 0; k < this->classfier_num; ++k){
+					this->weightMatrix[k][index_i] = trunc_weight(this->weightMatrix[k][index_i],
+						gravity *(this->sigmaWMatrix[k][index_i]));
+				}
 			}
 			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
 		}
@@ -168,6 +182,80 @@ namespace BOC {
 			return y;
 		}
 
+		/**
+		 * @Synopsis PredictMC predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = this->TrainPredict(this->weightMatrix[k], x);
+			}
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec update the weights of each classifier, the
+		 * learning rate and the L1 gravity are shared by the classifiers, so
+		 * that the lazy truncation is done once for each touched feature
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			if (gt_t[(int)x.label] == 0){
+				return;
+			}
+			size_t featDim = x.indexes.size();
+			//calculate learning rate with the variances of the updated classifiers
+			this->eta = this->r;
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (gt_t[k] == 0){
+					continue;
+				}
+				s_array<float>& sigma_w = this->sigmaWMatrix[k];
+				for (size_t i = 0; i < featDim; i++){
+					this->eta += x.features[i] * x.features[i] * sigma_w[x.indexes[i]];
+				}
+			}
+			this->eta = 0.5f / this->eta;
+			this->sum_rate.push_back(this->sum_rate.last() + this->eta * this->lambda);
+
+			float last_g_sum = this->sum_rate.last();
+			for (size_t i = 0; i < featDim; i++){
+				IndexType index_i = x.indexes[i];
+				float feat_sq = x.features[i] * x.features[i];
+				//L1 lazy update
+				float gravity = last_g_sum - this->sum_rate[this->timeStamp[index_i]];
+				this->timeStamp[index_i] = this->iter_num;
+
+				for (int k = 0; k < this->classfier_num; ++k){
+					float &w = this->weightMatrix[k][index_i];
+					float &sigma_w = this->sigmaWMatrix[k][index_i];
+					//update u_t
+					w -= this->eta * gt_t[k] * x.features[i] * sigma_w;
+					w = trunc_weight(w, gravity * sigma_w);
+					//update sigma_w
+					if (gt_t[k] != 0){
+						sigma_w *= this->r / (this->r + sigma_w * feat_sq);
+					}
+				}
+			}
+
+			//bias term
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (gt_t[k] == 0){
+					continue;
+				}
+				float &sigma_b = this->sigmaWMatrix[k][0];
+				this->weightMatrix[k][0] -= this->eta * gt_t[k] * sigma_b;
+				sigma_b *= this->r / (this->r + sigma_b);
+			}
+			this->timeStamp[0] = this->iter_num;
+
+			this->iter_num++;
+		}
+
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -178,10 +266,12 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->sigma_w.resize(new_dim + 1);
-				//set the rest to one
-				this->sigma_w.set_value(this->sigma_w.begin + this->weightDim,
-					this->sigma_w.end, 1);
+				for (int k = 0; k < this->classfier_num; ++k){
+					s_array<float>& sigma_w = this->sigmaWMatrix[k];
+					sigma_w.resize(new_dim + 1);
+					//set the rest to one
+					sigma_w.set_value(sigma_w.begin + this->weightDim, sigma_w.end, 1);
+				}
 
 				this->timeStamp.resize(new_dim + 1);
 				//set the rest to zero
@@ -191,6 +281,47 @@ namespace BOC {
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the variances, the time stamps and the
+		 * accumulated rates to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->sigmaWMatrix);
+			write_array(os, this->timeStamp);
+			write_array(os, this->sum_rate);
+			write_value(os, (uint64_t)this->iter_num);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the variances, the time stamps and the
+		 * accumulated rates from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			uint64_t iterNum = 0;
+			reader.read_array(this->sigmaWMatrix);
+			reader.read_array(this->timeStamp);
+			reader.read_array(this->sum_rate);
+			reader.read_value(iterNum);
+			this->iter_num = (size_t)iterNum;
+			return reader.ok();
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(CW_TG, "Confidence Weighted Truncated Gradient")
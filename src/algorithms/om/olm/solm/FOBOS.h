@@ -28,14 +28,18 @@ namespace BOC {
 		DECLARE_CLASS
 
 	protected:
-		s_array<size_t> timeStamp;
+		//per-feature states: time stamp of the last truncation and weight,
+		//the time stamps are 32-bit and compared modulo 2^32. For multiclass,
+		//the time stamp is shared by the classes and the weight is per class
+		enum { STATE_TS = 0, STATE_W = 1 };
+		feature_state<2> state;
 		float(*pEta_time)(size_t t, float pt);
 
 	public:
 		FOBOS(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
 			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
 			this->modelName = "FOBOS";
-			this->timeStamp.resize(this->weightDim);
+			this->state.resize(this->weightDim);
 		}
 
 		virtual ~FOBOS() {
@@ -51,7 +55,7 @@ namespace BOC {
 		virtual void BeginTrain() {
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
-			this->timeStamp.zeros();
+			this->InitState(this->state, 1);
 			if (this->power_t == 0.5)
 				this->pEta_time = pEta_sqrt;
 			else if (this->power_t == 0)
@@ -68,13 +72,28 @@ namespace BOC {
 		virtual void EndTrain() {
 			for (IndexType index_i = 1; index_i < this->weightDim; index_i++) {
 				//truncated gradient
-				size_t stepK = this->curIterNum - this->timeStamp[index_i];
-				this->weightVec[index_i] = trunc_weight(this->weightVec[index_i],
-					stepK * this->eta * this->lambda);
+				size_t stepK = (uint32_t)this->curIterNum - this->state.count(index_i, STATE_TS);
+				for (int k = 0; k < this->classfier_num; ++k){
+					this->state.real(index_i, STATE_W, k) = trunc_weight(this->state.real(index_i, STATE_W, k),
+						stepK * this->eta * this->lambda);
+				}
 			}
+
+			this->CopyStateWeights(this->state, STATE_W);
 			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
 		}
 
+		/**
+		 * @Synopsis PrefetchWeights prefetch the states of an example
+		 *
+		 * @Param x the example
+		 */
+		virtual void PrefetchWeights(const DataPoint<FeatType, LabelType> &x) const {
+			for (size_t i = 0; i < x.indexes.size(); ++i){
+				this->state.prefetch(x.indexes[i]);
+			}
+		}
+
 		/**
 		 * @Synopsis Iterate Iteration of online learning
 		 *
@@ -87,7 +106,9 @@ namespace BOC {
 			this->eta = this->eta0 / this->pEta_time(this->curIterNum, this->power_t);
 
 			size_t featDim = x.indexes.size();
-			float y = this->TrainPredict(this->weightVec, x);
+			//predict, the weights are kept with the states
+			float y = sparse_dot_strided(this->state.real_begin(STATE_W), this->state.stride(),
+				x.indexes.begin, x.features.begin, featDim) + this->state.real(0, STATE_W);
 			float gt_i = 0;
 			this->lossFunc->GetGradient(x.label, &y, &gt_i);
 			gt_i *= this->eta;
@@ -98,22 +119,87 @@ namespace BOC {
 			for (size_t i = 0; i < featDim; i++) {
 				index_i = x.indexes[i];
 				//update the weight
-				this->weightVec[index_i] -= gt_i * x.features[i];
+				float &w = this->state.real(index_i, STATE_W);
+				uint32_t &ts = this->state.count(index_i, STATE_TS);
+				w -= gt_i * x.features[i];
 
 				//lazy update
-				stepK = this->curIterNum - this->timeStamp[index_i];
-				this->timeStamp[index_i] = this->curIterNum;
+				stepK = (uint32_t)this->curIterNum - ts;
+				ts = (uint32_t)this->curIterNum;
 
-				this->weightVec[index_i] = trunc_weight(this->weightVec[index_i],
-					stepK * alpha);
+				w = trunc_weight(w, stepK * alpha);
 			}
 
 			//update bias term
-			this->weightVec[0] -= gt_i;
+			this->state.real(0, STATE_W) -= gt_i;
 
 			return y;
 		}
 
+		/**
+		 * @Synopsis PredictMC predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			this->eta = this->eta0 / this->pEta_time(this->curIterNum, this->power_t);
+
+			size_t featDim = x.indexes.size();
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = sparse_dot_strided(this->state.real_begin(STATE_W, k), this->state.stride(),
+					x.indexes.begin, x.features.begin, featDim) + this->state.real(0, STATE_W, k);
+			}
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec update the weights of each classifier, the
+		 * truncation is shared by the classifiers
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			size_t featDim = x.indexes.size();
+			float alpha = this->eta * this->lambda;
+			for (size_t i = 0; i < featDim; i++) {
+				IndexType index_i = x.indexes[i];
+				//lazy update, once for all the classifiers
+				uint32_t &ts = this->state.count(index_i, STATE_TS);
+				size_t stepK = (uint32_t)this->curIterNum - ts;
+				ts = (uint32_t)this->curIterNum;
+
+				for (int k = 0; k < this->classfier_num; ++k){
+					float &w = this->state.real(index_i, STATE_W, k);
+					w = trunc_weight(w - this->eta * gt_t[k] * x.features[i], stepK * alpha);
+				}
+			}
+
+			//update bias term
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->state.real(0, STATE_W, k) -= this->eta * gt_t[k];
+			}
+		}
+
+	protected:
+		/**
+		 * @Synopsis StateWeight the current weight of a feature kept in the
+		 * states, with the pending truncation applied
+		 *
+		 * @Param i index of the feature
+		 * @Param k index of the classifier
+		 */
+		virtual float StateWeight(IndexType i, int k) const {
+			float w = this->state.real(i, STATE_W, k);
+			if (i == 0){
+				return w;
+			}
+			size_t stepK = (uint32_t)this->curIterNum - this->state.count(i, STATE_TS);
+			return trunc_weight(w, stepK * this->eta * this->lambda);
+		}
+
+	public:
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -124,14 +210,42 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->timeStamp.resize(new_dim + 1);
-				//set the rest to zero
-				this->timeStamp.zeros(this->timeStamp.begin + this->weightDim,
-					this->timeStamp.end);
+				this->state.resize(new_dim + 1);
 
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the per-feature states to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			this->state.save(os);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the per-feature states from the
+		 * checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return this->state.load(reader);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(FOBOS, "Forward Backward Splitting")
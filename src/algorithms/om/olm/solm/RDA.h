@@ -25,17 +25,22 @@ namespace BOC {
 
 	protected:
 		float gamma_rou;
-		s_array<float> gtVec; //average gradient vector
+		//average gradient vector of each classifier
+		vector<s_array<float> > gtMatrix;
+		s_array<float>& gtVec; //average gradient vector of binary classification
 
 		/**
 		 * @Synopsis Constructors
 		 */
 	public:
 		RDA(LossFunction<FeatType, LabelType> *lossFunc, int classNum) :
-			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum) {
+			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum),
+			gtMatrix(this->classfier_num), gtVec(gtMatrix[0]) {
 			this->modelName = "RDA";
 			this->gamma_rou = init_gammarou;
-			this->gtVec.resize(this->weightDim);
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->gtMatrix[k].resize(this->weightDim);
+			}
 			//initail_t should be no less than 1,for the safety of update at the first step
 			this->initial_t = 1;
 		}
@@ -75,7 +80,9 @@ namespace BOC {
 			INVALID_ARGUMENT_EXCEPTION(gamma_rou, this->gamma_rou >= 0, "no smaller than 0");
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
-			this->gtVec.zeros();
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->gtMatrix[k].zeros();
+			}
 			//initail_t should be no less than 1,for the safety of update at the first step
 			if (this->initial_t < 1)
 				this->initial_t = 1;
@@ -120,6 +127,53 @@ namespace BOC {
 			return y;
 		}
 
+		/**
+		 * @Synopsis PredictMC obtain the weights of the touched features and
+		 * predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			float eta_coeff_time = pEta_sqrt(this->curIterNum, this->power_t);
+			this->eta = this->eta0 / eta_coeff_time;
+
+			size_t featDim = x.indexes.size();
+			//obtain w_t
+			float lambda_t = this->lambda * this->curIterNum + this->gamma_rou * eta_coeff_time;
+			for (int k = 0; k < this->classfier_num; ++k){
+				s_array<float>& weightVec = this->weightMatrix[k];
+				s_array<float>& gtVec = this->gtMatrix[k];
+				for (size_t i = 0; i < featDim; i++) {
+					IndexType index_i = x.indexes[i];
+					weightVec[index_i] = -this->eta * trunc_weight(gtVec[index_i], lambda_t);
+				}
+				weightVec[0] = -this->eta * gtVec[0];
+				predict[k] = this->TrainPredict(weightVec, x);
+			}
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec accumulate the gradients of each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			size_t featDim = x.indexes.size();
+			for (int k = 0; k < this->classfier_num; ++k){
+				if (gt_t[k] == 0){
+					continue;
+				}
+				s_array<float>& gtVec = this->gtMatrix[k];
+				for (size_t i = 0; i < featDim; i++)
+					gtVec[x.indexes[i]] += gt_t[k] * x.features[i];
+				//bias term
+				gtVec[0] += gt_t[k];
+			}
+		}
+
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -130,13 +184,44 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->gtVec.resize(new_dim + 1);
-				this->gtVec.zeros(this->gtVec.begin + this->weightDim,
-					this->gtVec.end);
+				for (int k = 0; k < this->classfier_num; ++k){
+					s_array<float>& gtVec = this->gtMatrix[k];
+					gtVec.resize(new_dim + 1);
+					gtVec.zeros(gtVec.begin + this->weightDim, gtVec.end);
+				}
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
 
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the average gradients to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			write_array(os, this->gtMatrix);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the average gradients from the checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return reader.read_array(this->gtMatrix);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(RDA, "Regularized Dual Averaging")
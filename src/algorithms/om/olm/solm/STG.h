@@ -25,7 +25,11 @@ namespace BOC {
 
 	protected:
 		int K;
-		s_array<size_t> timeStamp;
+		//per-feature states: time stamp of the last truncation and weight,
+		//the time stamps are 32-bit and compared modulo 2^32. For multiclass,
+		//the time stamp is shared by the classes and the weight is per class
+		enum { STATE_TS = 0, STATE_W = 1 };
+		feature_state<2> state;
 		float(*pEta_time)(size_t t, float pt);
 
 	public:
@@ -33,7 +37,7 @@ namespace BOC {
 			SparseOnlineLinearModel<FeatType, LabelType>(lossFunc, classNum){
 			this->modelName = "STG";
 			this->K = 10;
-			this->timeStamp.resize(this->weightDim);
+			this->state.resize(this->weightDim);
 		}
 
 		virtual ~STG(){
@@ -49,6 +53,7 @@ namespace BOC {
 		virtual void PrintModelSettings() const {
 			SparseOnlineLinearModel<FeatType, LabelType>::PrintModelSettings();
 			printf("\t\tk	: %d\n", this->K);
+			printf("\t\tstate layout	: %s\n", this->stateLayout.c_str());
 		}
 
 		/**
@@ -71,8 +76,8 @@ namespace BOC {
 			INVALID_ARGUMENT_EXCEPTION(K, this->K > 0, "larger than 0");
 			SparseOnlineLinearModel<FeatType, LabelType>::BeginTrain();
 
-			//reset time stamp
-			this->timeStamp.zeros();
+			//reset the states
+			this->InitState(this->state, 1);
 
 			if (this->power_t == 0.5)
 				this->pEta_time = pEta_sqrt;
@@ -90,15 +95,30 @@ namespace BOC {
 		virtual void EndTrain() {
 			for (IndexType index_i = 1; index_i < this->weightDim; index_i++) {
 				//truncated gradient
-				size_t stepK = this->curIterNum - this->timeStamp[index_i];
+				size_t stepK = (uint32_t)this->curIterNum - this->state.count(index_i, STATE_TS);
 				stepK -= stepK % this->K;
 
-				this->weightVec[index_i] = trunc_weight(this->weightVec[index_i],
-					stepK * this->lambda * this->eta);
+				for (int k = 0; k < this->classfier_num; ++k){
+					this->state.real(index_i, STATE_W, k) = trunc_weight(this->state.real(index_i, STATE_W, k),
+						stepK * this->lambda * this->eta);
+				}
 			}
+
+			this->CopyStateWeights(this->state, STATE_W);
 			SparseOnlineLinearModel<FeatType, LabelType>::EndTrain();
 		}
 
+		/**
+		 * @Synopsis PrefetchWeights prefetch the states of an example
+		 *
+		 * @Param x the example
+		 */
+		virtual void PrefetchWeights(const DataPoint<FeatType, LabelType> &x) const {
+			for (size_t i = 0; i < x.indexes.size(); ++i){
+				this->state.prefetch(x.indexes[i]);
+			}
+		}
+
 		/**
 		 * @Synopsis Iterate Iteration of online learning
 		 *
@@ -113,7 +133,9 @@ namespace BOC {
 			size_t featDim = x.indexes.size();
 			float alpha = this->eta * this->lambda;
 
-			float y = this->TrainPredict(this->weightVec, x);
+			//predict, the weights are kept with the states
+			float y = sparse_dot_strided(this->state.real_begin(STATE_W), this->state.stride(),
+				x.indexes.begin, x.features.begin, featDim) + this->state.real(0, STATE_W);
 			float gt_i = 0;
 			this->lossFunc->GetGradient(x.label, &y, &gt_i);
 			gt_i *= this->eta;
@@ -122,29 +144,108 @@ namespace BOC {
 			for (size_t i = 0; i < featDim; i++) {
 				IndexType index_i = x.indexes[i];
 				//update the weight
-				this->weightVec[index_i] -= gt_i * x.features[i];
+				float &w = this->state.real(index_i, STATE_W);
+				uint32_t &ts = this->state.count(index_i, STATE_TS);
+				w -= gt_i * x.features[i];
 
 				//lazy update the weight
 				//truncated gradient
-				if (this->timeStamp[index_i] == 0) {
-					this->timeStamp[index_i] = this->curIterNum;
+				if (ts == 0) {
+					ts = (uint32_t)this->curIterNum;
 					continue;
 				}
 				else{
-					stepK = this->curIterNum - this->timeStamp[index_i];
+					stepK = (uint32_t)this->curIterNum - ts;
 					if (stepK < size_t(this->K))
 						continue;
 
 					stepK -= stepK % this->K;
-					this->timeStamp[index_i] += stepK;
-					this->weightVec[index_i] = trunc_weight(this->weightVec[index_i],
-						stepK * alpha);
+					ts += (uint32_t)stepK;
+					w = trunc_weight(w, stepK * alpha);
 				}
 			}
 			//bias term
-			this->weightVec[0] -= gt_i;
+			this->state.real(0, STATE_W) -= gt_i;
 			return y;
 		}
+
+		/**
+		 * @Synopsis PredictMC predict the example by each classifier
+		 *
+		 * @Param x current input data example
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict) {
+			this->curIterNum++;
+			this->eta = this->eta0 / this->pEta_time(this->curIterNum, this->power_t);
+
+			size_t featDim = x.indexes.size();
+			for (int k = 0; k < this->classfier_num; ++k){
+				predict[k] = sparse_dot_strided(this->state.real_begin(STATE_W, k), this->state.stride(),
+					x.indexes.begin, x.features.begin, featDim) + this->state.real(0, STATE_W, k);
+			}
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec update the weights of each classifier, the
+		 * truncation is shared by the classifiers
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
+		 */
+		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t) {
+			size_t featDim = x.indexes.size();
+			float alpha = this->eta * this->lambda;
+
+			size_t stepK = 0;
+			for (size_t i = 0; i < featDim; i++) {
+				IndexType index_i = x.indexes[i];
+				//update the weights
+				for (int k = 0; k < this->classfier_num; ++k){
+					this->state.real(index_i, STATE_W, k) -= this->eta * gt_t[k] * x.features[i];
+				}
+
+				//lazy update the weights, once for all the classifiers
+				uint32_t &ts = this->state.count(index_i, STATE_TS);
+				if (ts == 0) {
+					ts = (uint32_t)this->curIterNum;
+					continue;
+				}
+				stepK = (uint32_t)this->curIterNum - ts;
+				if (stepK < size_t(this->K))
+					continue;
+
+				stepK -= stepK % this->K;
+				ts += (uint32_t)stepK;
+				for (int k = 0; k < this->classfier_num; ++k){
+					float &w = this->state.real(index_i, STATE_W, k);
+					w = trunc_weight(w, stepK * alpha);
+				}
+			}
+			//bias term
+			for (int k = 0; k < this->classfier_num; ++k){
+				this->state.real(0, STATE_W, k) -= this->eta * gt_t[k];
+			}
+		}
+	protected:
+		/**
+		 * @Synopsis StateWeight the current weight of a feature kept in the
+		 * states, with the pending truncation applied
+		 *
+		 * @Param i index of the feature
+		 * @Param k index of the classifier
+		 */
+		virtual float StateWeight(IndexType i, int k) const {
+			float w = this->state.real(i, STATE_W, k);
+			if (i == 0){
+				return w;
+			}
+			size_t stepK = (uint32_t)this->curIterNum - this->state.count(i, STATE_TS);
+			stepK -= stepK % this->K;
+			return trunc_weight(w, stepK * this->lambda * this->eta);
+		}
+
+	public:
 		/**
 		 * @Synopsis UpdateModelDimention update dimension of the model,
 		 * often caused by the increased dimension of data
@@ -155,14 +256,42 @@ namespace BOC {
 			if (new_dim < this->weightDim)
 				return;
 			else {
-				this->timeStamp.resize(new_dim + 1);
-				//set the rest to zero
-				this->timeStamp.zeros(this->timeStamp.begin + this->weightDim,
-					this->timeStamp.end);
+				this->state.resize(new_dim + 1);
 
 				SparseOnlineLinearModel<FeatType, LabelType>::UpdateModelDimention(new_dim);
 			}
 		}
+
+	protected:
+		/**
+		 * @Synopsis SaveModelState save the per-feature states to the checkpoint
+		 *
+		 * @Param os ostream object to which the state is saved
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModelState(std::ostream &os) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::SaveModelState(os) == false){
+				return false;
+			}
+			this->state.save(os);
+			return os.good();
+		}
+
+		/**
+		 * @Synopsis LoadModelState load the per-feature states from the
+		 * checkpoint
+		 *
+		 * @Param reader the state in the mapped checkpoint
+		 *
+		 * @Returns true if load successfully
+		 */
+		virtual bool LoadModelState(state_reader &reader) {
+			if (SparseOnlineLinearModel<FeatType, LabelType>::LoadModelState(reader) == false){
+				return false;
+			}
+			return this->state.load(reader);
+		}
 	};
 
 	IMPLEMENT_MODEL_CLASS(STG, "Sparse Truncated Gradient")
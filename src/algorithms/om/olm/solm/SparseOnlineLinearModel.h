@@ -8,6 +8,7 @@
 #define HEADER_SPARSE_LINEAR_ONLINE_MODEL
 
 #include "../OnlineLinearModel.h"
+#include "../../../../utils/feature_state.h"
 
 /**
 *  namespace: Batch and Online Classification
@@ -20,15 +21,31 @@ namespace BOC {
 		float lambda;
 		//weights below this threshold will eliminated at the end of training
 		float sparse_soft_thresh;
+		//layout of the per-feature states (aos or soa)
+		std::string stateLayout;
+		//precision of the per-feature states (fp32 or bf16)
+		std::string statePrecision;
+		//whether the states are kept in bf16, set when training begins
+		bool isHalfPrecision;
+		//whether the weights are kept in the per-feature states, set by InitState
+		bool isStateWeight;
+		//iteration number when the weights were copied from the states
+		size_t stateIterNum;
 
+		//weight vector of binary classification, the first one for multiclass
 		s_array<float>& weightVec;
 
 	public:
 		SparseOnlineLinearModel(LossFunction<FeatType, LabelType> *lossFunc, int classNum) 
 			: OnlineLinearModel<FeatType, LabelType>(lossFunc, classNum) ,
-			weightVec(*this->pWeightVecBC){
+			weightVec(this->weightMatrix[0]){
 				this->lambda = 0;
 				this->sparse_soft_thresh = init_sparse_soft_thresh;
+				this->stateLayout = init_state_layout;
+				this->statePrecision = init_state_precision;
+				this->isHalfPrecision = false;
+				this->isStateWeight = false;
+				this->stateIterNum = 0;
 			}
 
 		virtual ~SparseOnlineLinearModel() {
@@ -53,6 +70,25 @@ namespace BOC {
 			OnlineLinearModel<FeatType, LabelType>::PrintModelInfo();
 		}
 
+		/**
+		 * @Synopsis GetNonZeroNum get the number of nonzero weights, counted
+		 * in the states if the weights are not copied yet
+		 *
+		 * @Returns number of nonzero weights
+		 */
+		virtual IndexType GetNonZeroNum() const {
+			if (this->isStateWeight == false || this->stateIterNum == this->curIterNum){
+				return OnlineLinearModel<FeatType, LabelType>::GetNonZeroNum();
+			}
+			IndexType nonZeroNum = 0;
+			for (IndexType i = 1; i < this->weightDim; ++i){
+				if (this->StateWeight(i, 0) != 0){
+					++nonZeroNum;
+				}
+			}
+			return nonZeroNum;
+		}
+
 		/**
 		 * @Synopsis SetParameter set parameters for the learning model
 		 *
@@ -64,6 +100,8 @@ namespace BOC {
 			if (val >= 0) {
 				this->lambda = val;
 			}
+			this->stateLayout = param.StringValue("-layout");
+			this->statePrecision = param.StringValue("-precision");
 		}
 
 		/**
@@ -71,18 +109,40 @@ namespace BOC {
 		 */
 		virtual void BeginTrain() {
 			INVALID_ARGUMENT_EXCEPTION(lambda, this->lambda >= 0, "no smaller than 0");
+			INVALID_ARGUMENT_EXCEPTION(statePrecision, this->statePrecision == "fp32" ||
+				this->statePrecision == "bf16", "fp32 or bf16");
 			OnlineLinearModel<FeatType, LabelType>::BeginTrain();
+
+			this->isHalfPrecision = false;
+			if (this->statePrecision == "bf16"){
+				if (this->IsHalfPrecisionSupported() == true){
+					this->isHalfPrecision = true;
+				}
+				else{
+					fprintf(stderr, "bf16 states are not supported by %s, fp32 is used\n",
+						this->modelName.c_str());
+				}
+			}
 		}
 
+		/**
+		 * @Synopsis IsHalfPrecisionSupported whether the model can keep its
+		 * per-feature states in bf16
+		 */
+		virtual bool IsHalfPrecisionSupported() const { return false; }
+
 		/**
 		 * @Synopsis EndTrain called when a train ends
 		 */
 		virtual void EndTrain() {
 			//eliminate weights smaller than sparse_soft_thresh
-			for (IndexType i = 1; i < this->weightDim; i++){
-				if (this->weightVec[i] < this->sparse_soft_thresh &&
-					this->weightVec[i] > -this->sparse_soft_thresh){
-					this->weightVec[i] = 0;
+			for (int k = 0; k < this->classfier_num; ++k){
+				s_array<float>& weightVec = this->weightMatrix[k];
+				for (IndexType i = 1; i < this->weightDim; i++){
+					if (weightVec[i] < this->sparse_soft_thresh &&
+						weightVec[i] > -this->sparse_soft_thresh){
+						weightVec[i] = 0;
+					}
 				}
 			}
 
@@ -117,8 +177,16 @@ namespace BOC {
 		 * @Returns  predicted class of the current example
 		 */
 		virtual int IterateMC(const DataPoint<FeatType, LabelType> &x, float* predict){
-			fprintf(stderr, "multiclass is not supported yet!");
-			exit(1);
+			this->PredictMC(x, predict);
+			this->lossFunc->GetGradient(x.label, predict, this->mc_gradients.begin,
+				this->classifier_weight.begin, this->classfier_num);
+			this->UpdateWeightVec(x, this->mc_gradients.begin);
+
+			//not correct
+			if (this->mc_gradients[x.label] != 0){
+				return int(std::max_element(predict, predict + this->classfier_num) - predict);
+			}
+			return x.label;
 		}
 
 	protected:
@@ -132,14 +200,99 @@ namespace BOC {
 		virtual float Iterate(const DataPoint<FeatType, LabelType> &x) = 0;
 
 		/**
-		 * @Synopsis UpdateWeightVec Update the weight vector
+		 * @Synopsis PredictMC predict the example by each classifier in
+		 * multiclass iterations, the lazy updates of the touched features are
+		 * done here once for all the classifiers
 		 *
 		 * @Param x current input data example
-		 * @Param gt_t common part of the gradient
+		 * @Param predict predicted values, classifier number
+		 */
+		virtual void PredictMC(const DataPoint<FeatType, LabelType> &x, float* predict){
+			fprintf(stderr, "multiclass is not supported by %s!\n", this->modelName.c_str());
+			exit(1);
+		}
+
+		/**
+		 * @Synopsis UpdateWeightVec Update the weight vectors in multiclass
+		 * iterations, called after PredictMC
+		 *
+		 * @Param x current input data example
+		 * @Param gt_t common part of the gradient of each classifier
 		 */
 		virtual void UpdateWeightVec(const DataPoint<FeatType, LabelType> &x, float* gt_t){}
 
+		/**
+		 * @Synopsis PredictScores predict with the weights of the states if
+		 * they are not copied to the weight vectors yet, like the held-out
+		 * examples of cross validation during training
+		 *
+		 * @Param data input data sample
+		 * @Param predicts predicted values for each classifier
+		 */
+		virtual void PredictScores(const DataPoint<FeatType, LabelType> &data, float* predicts){
+			if (this->isStateWeight == false || this->stateIterNum == this->curIterNum){
+				OnlineLinearModel<FeatType, LabelType>::PredictScores(data, predicts);
+				return;
+			}
+			for (int k = 0; k < this->classfier_num; ++k){
+				predicts[k] = this->StateWeight(0, k);
+			}
+			size_t featDim = data.indexes.size();
+			for (size_t i = 0; i < featDim; ++i){
+				IndexType index_i = data.indexes[i];
+				if (index_i >= this->weightDim){
+					continue;
+				}
+				for (int k = 0; k < this->classfier_num; ++k){
+					predicts[k] += this->StateWeight(index_i, k) * data.features[i];
+				}
+			}
+		}
+
+		/**
+		 * @Synopsis StateWeight the current weight of a feature kept in the
+		 * states, with the pending lazy updates applied
+		 *
+		 * @Param i index of the feature
+		 * @Param k index of the classifier
+		 */
+		virtual float StateWeight(IndexType i, int k) const { return 0; }
+
 	protected:
+		/**
+		 * @Synopsis InitState set the layout of per-feature states and reset them
+		 *
+		 * @Param state per-feature states of the model
+		 * @Param shared_num number of the first fields shared by the classifiers
+		 */
+		template <typename StateType>
+		void InitState(StateType &state, int shared_num = 0) {
+			state.set_groups(this->classfier_num, shared_num);
+			bool is_valid = state.set_layout(this->stateLayout);
+			INVALID_ARGUMENT_EXCEPTION(stateLayout, is_valid, "aos or soa");
+			state.resize(this->weightDim);
+			state.zeros();
+			this->isStateWeight = true;
+		}
+
+		/**
+		 * @Synopsis CopyStateWeights copy the weights kept in the per-feature
+		 * states to the weight vector
+		 *
+		 * @Param state per-feature states of the model
+		 * @Param field index of the weight in the states
+		 */
+		template <typename StateType>
+		void CopyStateWeights(const StateType &state, int field) {
+			for (int k = 0; k < this->classfier_num; ++k){
+				s_array<float>& weightVec = this->weightMatrix[k];
+				for (IndexType i = 0; i < this->weightDim; ++i){
+					weightVec[i] = state.get(i, field, k);
+				}
+			}
+			this->stateIterNum = this->curIterNum;
+		}
+
 		/**
 		 * @Synopsis SaveModelConfig save configuration of model to disk
 		 *
@@ -147,7 +300,7 @@ namespace BOC {
 		 *
 		 * @Returns true if saved successfully
 		 */
-		virtual bool SaveModelConfig(std::ofstream &os) {
+		virtual bool SaveModelConfig(std::ostream &os) {
 			OnlineLinearModel<FeatType, LabelType>::SaveModelConfig(os);
 
 			//l1 regularization
@@ -163,7 +316,7 @@ namespace BOC {
 		 *
 		 * @Returns true if load successfully
 		 */
-		virtual bool LoadModelConfig(std::ifstream &is) {
+		virtual bool LoadModelConfig(std::istream &is) {
 			OnlineLinearModel<FeatType, LabelType>::LoadModelConfig(is);
 
 			string line;
@@ -0,0 +1,612 @@
+/*************************************************************************
+	> File Name: sol_bench.cpp
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 11:05:23 PM
+	> Functions: micro-benchmarks of parsing, the cache codec, the models
+	> and the heaps on synthetic data, the results are printed in JSON
+	************************************************************************/
+#include "../BOC.h"
+#include "../utils/init_param.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+using namespace BOC;
+
+typedef float FeatType;
+typedef char LabelType;
+typedef DataPoint<FeatType, LabelType> BenchPoint;
+
+//models benchmarked by default, PreSelOGD needs the features selected
+//by another model and is only run if given by -m
+static const char* default_models = "SGD,STG,RDA,FOBOS,Ada_FOBOS,Ada_RDA,CW_RDA,CW_TG,DAROW,FOFS,SOFS,PET";
+
+//results are accumulated here, so that the work is not optimized away
+static volatile double bench_sink = 0;
+
+//xorshift random numbers, the same sequence on every platform
+class bench_random {
+	uint32_t state;
+public:
+	bench_random(uint32_t seed) : state(seed == 0 ? 2463534242u : seed) {}
+
+	inline uint32_t next() {
+		this->state ^= this->state << 13;
+		this->state ^= this->state >> 17;
+		this->state ^= this->state << 5;
+		return this->state;
+	}
+	//uniform in [0, 1)
+	inline float uniform() {
+		return (this->next() >> 8) / 16777216.f;
+	}
+	//uniform in [0, n)
+	inline uint32_t below(uint32_t n) {
+		return (uint32_t)(((uint64_t)this->next() * n) >> 32);
+	}
+};
+
+//quoted JSON string of the text, with the quotes, the backslashes and the
+//control characters escaped
+string JsonString(const string &text) {
+	string ret = "\"";
+	char buf[8];
+	for (size_t i = 0; i < text.length(); ++i){
+		unsigned char c = (unsigned char)text[i];
+		if (c == '"' || c == '\\'){
+			ret += '\\';
+			ret += (char)c;
+		}
+		else if (c < 0x20){
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			ret += buf;
+		}
+		else{
+			ret += (char)c;
+		}
+	}
+	return ret + "\"";
+}
+
+struct BenchResult {
+	string name;
+	//operations and bytes processed by a run
+	size_t ops;
+	size_t bytes;
+	//seconds of each run
+	vector<double> seconds;
+};
+
+/**
+ * The benchmarks run the same work on the same data for a number of times,
+ * the minimum and the median of the times are reported.
+ */
+class bench_suite {
+protected:
+	int repeats;
+	string filter;
+	vector<BenchResult> results;
+
+	//current benchmark
+	BenchResult* cur;
+	double start_time;
+
+public:
+	bench_suite(int repeats, const string &filter) : repeats(repeats), filter(filter), cur(NULL), start_time(0) {
+	}
+
+	inline int Repeats() const { return this->repeats; }
+
+	/**
+	 * @Synopsis Begin begin a benchmark
+	 *
+	 * @Param name name of the benchmark, like "parser/parseFloat"
+	 * @Param ops operations of a run
+	 * @Param bytes bytes processed by a run, 0 if not meaningful
+	 *
+	 * @Returns false if the benchmark is not selected
+	 */
+	bool Begin(const string &name, size_t ops, size_t bytes = 0) {
+		this->cur = NULL;
+		if (this->filter.length() > 0 && name.find(this->filter) == string::npos){
+			return false;
+		}
+		BenchResult result;
+		result.name = name;
+		result.ops = ops;
+		result.bytes = bytes;
+		this->results.push_back(result);
+		this->cur = &this->results.back();
+		fprintf(stderr, "running %s\n", name.c_str());
+		return true;
+	}
+
+	inline void Start() {
+		this->start_time = get_current_time();
+	}
+
+	inline void Stop() {
+		this->cur->seconds.push_back(get_current_time() - this->start_time);
+	}
+
+	/**
+	 * @Synopsis Print print the config and the results as a JSON object
+	 */
+	void Print(const string &config) const {
+		printf("{\n\"config\": %s,\n\"benchmarks\": [", config.c_str());
+		for (size_t i = 0; i < this->results.size(); ++i){
+			const BenchResult &result = this->results[i];
+			vector<double> seconds = result.seconds;
+			sort(seconds.begin(), seconds.end());
+			double min_sec = seconds.empty() ? 0 : seconds[0];
+			double median_sec = seconds.empty() ? 0 : seconds[seconds.size() / 2];
+			printf("%s\n{\"name\": %s, \"runs\": %lu, \"ops\": %lu, \"bytes\": %lu, "
+				"\"min_seconds\": %.6f, \"median_seconds\": %.6f, \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f",
+				i == 0 ? "" : ",", JsonString(result.name).c_str(), seconds.size(), result.ops, result.bytes,
+				min_sec, median_sec, min_sec * 1e9 / max(result.ops, size_t(1)),
+				min_sec > 0 ? result.ops / min_sec : 0);
+			if (result.bytes > 0){
+				printf(", \"mb_per_sec\": %.3f", min_sec > 0 ? result.bytes / min_sec / 1048576 : 0);
+			}
+			printf("}");
+		}
+		printf("\n]\n}\n");
+	}
+};
+
+/**
+ * @Synopsis GenerateData examples with feat_num distinct sorted indexes in
+ * [1, dim], the labels of the binary examples are the signs and those of
+ * the multiclass examples are the maximum of random linear functions
+ */
+void GenerateData(bench_random &rng, size_t data_num, IndexType dim, int feat_num, int class_num,
+	vector<BenchPoint> &bc_data, vector<BenchPoint> &mc_data) {
+	vector<float> w_true((size_t)dim * class_num);
+	for (size_t i = 0; i < w_true.size(); ++i){
+		w_true[i] = rng.uniform() - 0.5f;
+	}
+
+	//copies of an example share the arrays, so each example is built before
+	//it is added
+	bc_data.clear();
+	mc_data.clear();
+	vector<IndexType> indexes;
+	for (size_t n = 0; n < data_num; ++n){
+		indexes.clear();
+		for (int i = 0; i < feat_num; ++i){
+			indexes.push_back(rng.below(dim) + 1);
+		}
+		sort(indexes.begin(), indexes.end());
+		indexes.erase(unique(indexes.begin(), indexes.end()), indexes.end());
+
+		BenchPoint data;
+		vector<float> scores(class_num, 0);
+		for (size_t i = 0; i < indexes.size(); ++i){
+			FeatType feat = rng.uniform();
+			data.AddNewFeat(indexes[i], feat);
+			for (int k = 0; k < class_num; ++k){
+				scores[k] += w_true[(size_t)k * dim + indexes[i] - 1] * feat;
+			}
+		}
+		data.label = scores[0] > 0 ? 1 : -1;
+		data.is_strict = sparse_is_strict(data.indexes.begin, data.indexes.size());
+		bc_data.push_back(data);
+		//the multiclass example shares the features
+		mc_data.push_back(data);
+		mc_data.back().label = (LabelType)(max_element(scores.begin(), scores.end()) - scores.begin());
+	}
+}
+
+void BenchParser(bench_suite &suite, bench_random &rng, size_t num) {
+	string float_text, uint_text;
+	char buf[64];
+	for (size_t i = 0; i < num; ++i){
+		sprintf(buf, "%g ", rng.uniform() * 10 - 5);
+		float_text += buf;
+		sprintf(buf, "%u ", rng.next() >> 8);
+		uint_text += buf;
+	}
+	vector<char> text(float_text.begin(), float_text.end());
+	text.push_back('\0');
+	if (suite.Begin("parser/parseFloat", num, float_text.length())){
+		for (int r = 0; r < suite.Repeats(); ++r){
+			suite.Start();
+			float sum = 0;
+			char* p = &text[0], *endptr = NULL;
+			while (true){
+				float val = parseFloat(p, &endptr);
+				if (endptr == p){
+					break;
+				}
+				sum += val;
+				p = endptr;
+			}
+			suite.Stop();
+			bench_sink += sum;
+		}
+	}
+
+	text.assign(uint_text.begin(), uint_text.end());
+	text.push_back('\0');
+	if (suite.Begin("parser/parseUint", num, uint_text.length())){
+		for (int r = 0; r < suite.Repeats(); ++r){
+			suite.Start();
+			size_t sum = 0;
+			char* p = &text[0], *endptr = NULL;
+			while (true){
+				unsigned int val = parseUint(p, &endptr);
+				if (endptr == p){
+					break;
+				}
+				sum += val;
+				p = endptr;
+			}
+			suite.Stop();
+			bench_sink += sum;
+		}
+	}
+}
+
+void BenchComp(bench_suite &suite, const vector<BenchPoint> &data) {
+	size_t index_num = 0;
+	vector<s_array<char> > codes;
+	for (size_t n = 0; n < data.size(); ++n){
+		index_num += data[n].indexes.size();
+		s_array<char> code;
+		comp_index(data[n].indexes, code);
+		codes.push_back(code);
+	}
+
+	if (suite.Begin("comp/comp_index", index_num, index_num * sizeof(IndexType))){
+		s_array<char> buf;
+		for (int r = 0; r < suite.Repeats(); ++r){
+			size_t code_len = 0;
+			suite.Start();
+			for (size_t n = 0; n < data.size(); ++n){
+				buf.erase();
+				comp_index(data[n].indexes, buf);
+				code_len += buf.size();
+			}
+			suite.Stop();
+			bench_sink += code_len;
+		}
+	}
+
+	if (suite.Begin("comp/decomp_index", index_num, index_num * sizeof(IndexType))){
+		s_array<IndexType> indexes;
+		for (int r = 0; r < suite.Repeats(); ++r){
+			size_t sum = 0;
+			suite.Start();
+			for (size_t n = 0; n < data.size(); ++n){
+				decomp_index(codes[n], indexes);
+				sum += indexes.last();
+			}
+			suite.Stop();
+			bench_sink += sum;
+		}
+	}
+}
+
+/**
+ * @Synopsis ReadAll read all the examples of a file
+ *
+ * @Returns number of examples, the sum of the features is added to sum
+ */
+size_t ReadAll(DataReader<FeatType, LabelType> &reader, double &sum) {
+	if (reader.OpenReading() == false){
+		return 0;
+	}
+	BenchPoint data;
+	size_t data_num = 0;
+	while (reader.GetNextData(data) == true){
+		for (size_t i = 0; i < data.features.size(); ++i){
+			sum += data.features[i];
+		}
+		data_num++;
+	}
+	reader.Close();
+	return data_num;
+}
+
+bool BenchIO(bench_suite &suite, const vector<BenchPoint> &data, const string &tmp_prefix) {
+	double data_sum = 0;
+	size_t feat_num = 0;
+	for (size_t n = 0; n < data.size(); ++n){
+		feat_num += data[n].features.size();
+		for (size_t i = 0; i < data[n].features.size(); ++i){
+			data_sum += data[n].features[i];
+		}
+	}
+
+	string libsvm_file = tmp_prefix + ".libsvm";
+	libsvm_io<FeatType, LabelType> libsvm_writer(libsvm_file);
+	if (libsvm_writer.OpenWriting() == false){
+		fprintf(stderr, "Error %d: open %s failed\n", STATUS_IO_ERROR, libsvm_file.c_str());
+		return false;
+	}
+	for (size_t n = 0; n < data.size(); ++n){
+		libsvm_writer.WriteData(const_cast<BenchPoint&>(data[n]));
+	}
+	libsvm_writer.Close();
+
+	libsvm_io<FeatType, LabelType> libsvm_reader(libsvm_file);
+	if (suite.Begin("libsvm_io/GetNextData", feat_num)){
+		for (int r = 0; r < suite.Repeats(); ++r){
+			double sum = 0;
+			suite.Start();
+			size_t data_num = ReadAll(libsvm_reader, sum);
+			suite.Stop();
+			if (data_num != data.size()){
+				fprintf(stderr, "Error %d: %lu of %lu examples read from %s\n", STATUS_IO_ERROR,
+					data_num, data.size(), libsvm_file.c_str());
+				return false;
+			}
+			bench_sink += sum;
+		}
+	}
+	remove(libsvm_file.c_str());
+
+	string binary_file = tmp_prefix + ".bin";
+	binary_io<FeatType, LabelType> binary_handler(binary_file);
+	if (suite.Begin("binary_io/WriteData", feat_num)){
+		for (int r = 0; r < suite.Repeats(); ++r){
+			suite.Start();
+			binary_handler.OpenWriting();
+			for (size_t n = 0; n < data.size(); ++n){
+				binary_handler.WriteData(const_cast<BenchPoint&>(data[n]));
+			}
+			binary_handler.Close();
+			suite.Stop();
+		}
+	}
+	else{
+		binary_handler.OpenWriting();
+		for (size_t n = 0; n < data.size(); ++n){
+			binary_handler.WriteData(const_cast<BenchPoint&>(data[n]));
+		}
+		binary_handler.Close();
+	}
+
+	if (suite.Begin("binary_io/GetNextData", feat_num)){
+		for (int r = 0; r < suite.Repeats(); ++r){
+			double sum = 0;
+			suite.Start();
+			size_t data_num = ReadAll(binary_handler, sum);
+			suite.Stop();
+			//the features are stored as they are, so the round trip is exact
+			if (data_num != data.size() || sum != data_sum){
+				fprintf(stderr, "Error %d: the examples read from %s are different from the written ones\n",
+					STATUS_IO_ERROR, binary_file.c_str());
+				return false;
+			}
+			bench_sink += sum;
+		}
+	}
+	remove(binary_file.c_str());
+	return true;
+}
+
+/**
+ * @Synopsis CreateModel create a model with the hinge loss, or with the
+ * squared hinge loss if the hinge loss is not supported by the model
+ *
+ * @Returns the model, NULL if no loss is supported
+ */
+OnlineModel<FeatType, LabelType>* CreateModel(const string &model_name, int class_num,
+	LossFunction<FeatType, LabelType>* &loss) {
+	const char* bc_losses[] = { "Hinge", "SquaredHinge" };
+	const char* mc_losses[] = { "MaxScoreHinge", "MaxScoreSquaredHinge" };
+	const char** loss_names = class_num > 2 ? mc_losses : bc_losses;
+	for (int i = 0; i < 2; ++i){
+		loss = (LossFunction<FeatType, LabelType>*)Registry::CreateObject(loss_names[i]);
+		try{
+			return (OnlineModel<FeatType, LabelType>*)Registry::CreateObject(model_name, loss,
+				(void*)(size_t)class_num);
+		}
+		catch (invalid_argument &ex){
+			delete loss;
+			loss = NULL;
+			if (i == 1){
+				fprintf(stderr, "%s\n", ex.what());
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @Synopsis BenchModel online training and prediction of a model
+ *
+ * TrainPredict and UpdateWeightVec are protected, they are timed through
+ * IterateBC and IterateMC, which predict, compute the gradient and update.
+ * Predict times the prediction alone on the trained model.
+ */
+bool BenchModel(bench_suite &suite, Params &param, const string &model_name,
+	const vector<BenchPoint> &data, IndexType dim, int class_num) {
+	bool is_mc = class_num > 2;
+	vector<float> predicts(is_mc ? class_num : 1);
+	LossFunction<FeatType, LabelType>* loss = NULL;
+	OnlineModel<FeatType, LabelType>* model = CreateModel(model_name, class_num, loss);
+	if (model == NULL){
+		return false;
+	}
+	string prefix = "model/" + model_name + (is_mc ? "/mc/" : "/bc/");
+	bool is_iterate = suite.Begin(prefix + (is_mc ? "IterateMC" : "IterateBC"), data.size());
+	try{
+		//a new model in each run, so that every run does the same updates
+		for (int r = 0; r < suite.Repeats(); ++r){
+			if (r > 0){
+				delete model;
+				model = (OnlineModel<FeatType, LabelType>*)Registry::CreateObject(model_name, loss,
+					(void*)(size_t)class_num);
+			}
+			model->SetParameter(param);
+			model->BeginTrain();
+			model->UpdateModelDimention(dim);
+
+			size_t error_num = 0;
+			if (is_iterate){
+				suite.Start();
+			}
+			if (is_mc){
+				for (size_t n = 0; n < data.size(); ++n){
+					error_num += model->IterateMC(data[n], &predicts[0]) != data[n].label;
+				}
+			}
+			else{
+				for (size_t n = 0; n < data.size(); ++n){
+					error_num += model->IterateBC(data[n], &predicts[0]) != data[n].label;
+				}
+			}
+			if (is_iterate){
+				suite.Stop();
+			}
+			model->EndTrain();
+			//Test and -serve predict with the frozen weights
+			model->Freeze();
+			bench_sink += error_num;
+			if (is_iterate == false){
+				break;
+			}
+		}
+
+		if (suite.Begin(prefix + "Predict", data.size())){
+			for (int r = 0; r < suite.Repeats(); ++r){
+				size_t error_num = 0;
+				suite.Start();
+				for (size_t n = 0; n < data.size(); ++n){
+					error_num += model->Predict(data[n], &predicts[0]) != data[n].label;
+				}
+				suite.Stop();
+				bench_sink += error_num;
+			}
+		}
+	}
+	catch (invalid_argument &ex){
+		fprintf(stderr, "%s\n", ex.what());
+		delete model;
+		delete loss;
+		return false;
+	}
+	delete model;
+	delete loss;
+	return true;
+}
+
+template <typename HeapType>
+void BenchHeap(bench_suite &suite, bench_random &rng, const string &name, IndexType dim, IndexType topK,
+	size_t update_num) {
+	if (suite.Begin(name, update_num) == false){
+		return;
+	}
+	vector<float> init_values(dim);
+	for (size_t i = 0; i < dim; ++i){
+		init_values[i] = rng.uniform();
+	}
+	vector<IndexType> ids(update_num);
+	vector<float> new_values(update_num);
+	for (size_t i = 0; i < update_num; ++i){
+		ids[i] = rng.below(dim);
+		new_values[i] = rng.uniform();
+	}
+
+	vector<float> values;
+	for (int r = 0; r < suite.Repeats(); ++r){
+		values = init_values;
+		HeapType heap;
+		heap.Init(dim, topK, &values[0]);
+		size_t replace_num = 0;
+		IndexType ret_id = 0;
+		suite.Start();
+		for (size_t i = 0; i < update_num; ++i){
+			values[ids[i]] = new_values[i];
+			replace_num += heap.UpdateHeap(ids[i], ret_id);
+		}
+		suite.Stop();
+		bench_sink += replace_num;
+	}
+}
+
+void InitParams(Params &param) {
+	string overview = "Sparse Online Learning Library - Micro Benchmarks";
+	string syntax = "sol_bench [options]";
+	string example = "sol_bench -b model/SGD -r 10";
+	param.Init(overview, syntax, example);
+
+	param.add_option(10000, 0, 1, "number of examples", "-n", " ");
+	param.add_option(100000, 0, 1, "dimension of the examples", "-d", " ");
+	param.add_option(50, 0, 1, "number of features of an example", "-f", " ");
+	param.add_option(4, 0, 1, "number of classes of the multiclass examples", "-cn", " ");
+	param.add_option(5, 0, 1, "number of runs of a benchmark", "-r", " ");
+	param.add_option(1, 0, 1, "seed of the synthetic data", "-seed", " ");
+	param.add_option("", 0, 1, "run the benchmarks whose name contains the string", "-b", " ");
+	param.add_option(default_models, 0, 1, "models to benchmark, separated by comma", "-m", " ");
+	param.add_option("sol_bench", 0, 1, "prefix of the temporary files", "-tmp", " ");
+}
+
+int main(int argc, const char** args) {
+	Params param;
+	InitParams(param);
+	//the defaults are used without arguments
+	if (argc > 1 && param.Parse(argc, args) == false){
+		return -1;
+	}
+	int data_num = param.IntValue("-n");
+	int dim = param.IntValue("-d");
+	int feat_num = param.IntValue("-f");
+	int class_num = param.IntValue("-cn");
+	int repeats = param.IntValue("-r");
+	int seed = param.IntValue("-seed");
+	if (data_num < 1 || dim < 1 || feat_num < 1 || class_num < 3 || repeats < 1){
+		fprintf(stderr, "Error %d: -n, -d, -f and -r must be positive, -cn must be larger than 2\n",
+			STATUS_INVALID_ARGUMENT);
+		return STATUS_INVALID_ARGUMENT;
+	}
+
+	//parameters of the models, with the defaults of SOL
+	Params model_param;
+	LibBOC<FeatType, LabelType> libBoc;
+	libBoc.InitParams(model_param);
+
+	bench_random rng((uint32_t)seed);
+	vector<BenchPoint> bc_data, mc_data;
+	GenerateData(rng, data_num, dim, feat_num, class_num, bc_data, mc_data);
+
+	bench_suite suite(repeats, param.StringValue("-b"));
+	BenchParser(suite, rng, (size_t)data_num * feat_num);
+	BenchComp(suite, bc_data);
+	if (BenchIO(suite, bc_data, param.StringValue("-tmp")) == false){
+		return STATUS_IO_ERROR;
+	}
+
+	string models = param.StringValue("-m");
+	size_t begin = 0;
+	while (begin < models.length()){
+		size_t end = models.find(',', begin);
+		end = end == string::npos ? models.length() : end;
+		string model_name = models.substr(begin, end - begin);
+		begin = end + 1;
+		if (model_name.length() == 0){
+			continue;
+		}
+		if (BenchModel(suite, model_param, model_name, bc_data, dim, 2) == false ||
+			BenchModel(suite, model_param, model_name, mc_data, dim, class_num) == false){
+			return STATUS_INVALID_ARGUMENT;
+		}
+	}
+
+	IndexType top_k = max(dim / 100, 1);
+	BenchHeap<MinHeap<float, IndexType> >(suite, rng, "heap/MinHeap/UpdateHeap", dim, top_k, (size_t)data_num * feat_num);
+	BenchHeap<MaxHeap<float, IndexType> >(suite, rng, "heap/MaxHeap/UpdateHeap", dim, top_k, (size_t)data_num * feat_num);
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "{\"data_num\": %d, \"dim\": %d, \"feat_num\": %d, \"class_num\": %d, "
+		"\"repeats\": %d, \"seed\": %d, \"filter\": ",
+		data_num, dim, feat_num, class_num, repeats, seed);
+	string config = buf + JsonString(param.StringValue("-b")) + "}";
+	suite.Print(config);
+	return 0;
+}
@@ -98,6 +98,12 @@ void Cache(Params &param){
 		}
 	}
 	printf("%lu samples cached\n",dataNum);
+
+	//statistics written in the header of the cache file
+	binary_io<float, char> cached(param.StringValue("-o"));
+	if (cached.OpenReading() == true && cached.GetStats() != NULL){
+		cached.GetStats()->Print();
+	}
 	if (reader != NULL)
 		delete reader;
 }
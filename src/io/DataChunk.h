@@ -18,8 +18,13 @@ namespace BOC {
 	struct DataChunk{
 		vector<ElemType> data;
 		size_t dataNum;
+		//max feature index of the examples, maintained by the writer of the chunk
+		IndexType max_index;
+		//bytes read from the input for the examples, 0 if they are not read
+		//from the input, maintained by the writer of the chunk
+		size_t read_bytes;
 
-		DataChunk() :dataNum(0){}
+		DataChunk() :dataNum(0), max_index(0), read_bytes(0){}
 	};
 
 	template <typename ElemType>
@@ -59,6 +64,8 @@ namespace BOC {
 			for (size_t i = 0; i < this->chunk_size; i++)
 				this->data[i].erase();
 			this->dataNum = 0;
+			this->max_index = 0;
+			this->read_bytes = 0;
 		}
 	};
 }
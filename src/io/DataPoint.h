@@ -31,11 +31,15 @@ namespace BOC {
 		int *count;
 
 		IndexType max_index; //max index, also the dimension
+		//indexes strictly increasing and in the range of the vector kernels,
+		//checked once by the loader, false takes the scalar path
+		bool is_strict;
 	public:
 		DataPoint() {
 			this->count = new int;
 			*count = 1;
 			this->max_index = 0;
+			this->is_strict = false;
 			this->label = 0;
 			this->sum_sq = 0;
 			this->margin = 0;
@@ -48,6 +52,7 @@ namespace BOC {
 			this->label = point.label;
 			this->count = point.count;
 			this->max_index = point.max_index;
+			this->is_strict = point.is_strict;
 			this->sum_sq = point.sum_sq;
 			this->margin = point.margin;
 			++(*count);
@@ -68,6 +73,7 @@ namespace BOC {
 			this->features = data.features;
 			this->label = data.label;
 			this->max_index = data.max_index;
+			this->is_strict = data.is_strict;
 			this->sum_sq = data.sum_sq;
 			this->margin = data.margin;
 			this->count = data.count;
@@ -89,12 +95,14 @@ namespace BOC {
 			this->indexes.erase();
 			this->features.erase();
 			this->max_index = 0;
+			this->is_strict = false;
 			this->sum_sq = 0;
 			this->margin = 0;
 		}
 		void clone(DataPoint<FeatType, LabelType> &dstPt) const{
 			dstPt.label = this->label;
 			dstPt.max_index = this->max_index;
+			dstPt.is_strict = this->is_strict;
 			dstPt.sum_sq = this->sum_sq;
 			dstPt.margin = this->margin;
 			dstPt.indexes.reserve(this->indexes.size());
@@ -109,6 +117,7 @@ namespace BOC {
 			DataPoint<FeatType, LabelType> newPt;
 			newPt.label = this->label;
 			newPt.max_index = this->max_index;
+			newPt.is_strict = this->is_strict;
 			newPt.sum_sq = this->sum_sq;
 			newPt.margin = this->margin;
 			newPt.indexes.reserve(this->indexes.size());
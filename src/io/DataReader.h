@@ -9,6 +9,7 @@
 #define HEADER_DATAREADER
 
 #include "DataPoint.h"
+#include "DataStats.h"
 #include "../utils/reflector.h"
 
 #include <string>
@@ -67,6 +68,20 @@ namespace BOC {
 		* @Return: true if everything is ok
 		*/
 		virtual bool Good() = 0;
+
+		/**
+		* GetStats : global statistics of the dataset, like the number of
+		* examples and the max index, known before reading the data
+		*
+		* @Return: NULL if not known
+		*/
+		virtual const DataStats* GetStats() const { return NULL; }
+
+		/**
+		* GetReadBytes : number of bytes read from the file since it is
+		* opened, including the passes after rewinding
+		*/
+		virtual size_t GetReadBytes() const { return 0; }
 	};
 
 }
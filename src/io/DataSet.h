@@ -10,6 +10,8 @@
 
 #include "DataPoint.h"
 #include "DataChunk.h"
+#include "PipelineStats.h"
+#include "../utils/feature_map.h"
 
 #include <string>
 
@@ -34,9 +36,14 @@ namespace BOC {
 		DataReader<FeatType, LabelType> *self_reader;
 		typedef DataPoint<FeatType, LabelType> PointType;
 
+		//map of the feature indexes to the weight slots, updated by the data
+		feature_map feat_map;
+		//map of the training data, which the test data is looked up in
+		const feature_map *train_map;
+
 	public:
 		DataSet()
-			: data_num(0), is_cache(false), is_norm(NULL), reader(NULL), self_reader(NULL)
+			: data_num(0), is_cache(false), is_norm(NULL), reader(NULL), self_reader(NULL), train_map(NULL)
 		{ }
 
 		virtual ~DataSet(){
@@ -155,6 +162,49 @@ namespace BOC {
 		 */
 		inline size_t size() const { return this->data_num; }
 
+		/**
+		 * @Synopsis GetStats statistics of the dataset in the header of the
+		 * file, available after loading a binary file
+		 *
+		 * @Returns NULL if not known
+		 */
+		inline const DataStats* GetStats() const {
+			return this->reader == NULL ? NULL : this->reader->GetStats();
+		}
+
+		/**
+		 * @Synopsis GetFeatureMap the feature map of the data, configured
+		 * before loading and shared with the models trained on the data
+		 */
+		inline feature_map& GetFeatureMap() { return this->feat_map; }
+
+		/**
+		 * @Synopsis SetTrainFeatureMap map the features of test data with the
+		 * map of the training data, which is not changed
+		 */
+		inline void SetTrainFeatureMap(const feature_map *map) { this->train_map = map; }
+
+		/**
+		 * @Synopsis GetPassNum number of passes over the data
+		 */
+		virtual int GetPassNum() const { return 1; }
+
+		/**
+		 * @Synopsis GetBufferOccupancy fraction of the buffer filled with
+		 * loaded data waiting to be processed
+		 *
+		 * @Returns -1 if the data is not buffered
+		 */
+		virtual float GetBufferOccupancy() { return -1; }
+
+		/**
+		 * @Synopsis GetPipelineStats time of the loading stages and the waits
+		 * between the loader and the learner
+		 *
+		 * @Returns false if the data is not loaded in parallel
+		 */
+		virtual bool GetPipelineStats(PipelineStats &stats) { return false; }
+
 		/**
 		 * @Synopsis Rewind Reset the reader to the beginning
 		 */
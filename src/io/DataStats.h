@@ -0,0 +1,95 @@
+/*************************************************************************
+	> File Name: DataStats.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 11:48:20 PM
+	> Functions: global statistics of a dataset, kept in the header of the
+	> binary files
+	************************************************************************/
+
+#ifndef HEADER_DATA_STATS
+#define HEADER_DATA_STATS
+
+#include "DataPoint.h"
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+
+namespace BOC {
+	//maximum number of labels in the class histogram
+#define DATA_STATS_MAX_CLASS 64
+
+	/**
+	 * The struct is written to the files as it is, the fields are ordered so
+	 * that there is no padding.
+	 */
+	struct DataStats {
+		char magic[8];
+		uint32_t version;
+		//number of labels in the histogram
+		uint32_t class_num;
+		uint64_t data_num;
+		//number of non-zero features
+		uint64_t nnz;
+		uint64_t max_index;
+		//number of examples of each label
+		uint64_t class_count[DATA_STATS_MAX_CLASS];
+		int32_t class_label[DATA_STATS_MAX_CLASS];
+
+		DataStats() {
+			this->Reset();
+		}
+
+		void Reset() {
+			std::memset(this, 0, sizeof(DataStats));
+			std::memcpy(this->magic, "SOLCACHE", 8);
+			this->version = 1;
+		}
+
+		//whether the header is read from a file of the same format
+		bool IsValid() const {
+			return std::memcmp(this->magic, "SOLCACHE", 8) == 0 && this->version == 1;
+		}
+
+		//whether the statistics are known, they are not if writing did not finish
+		bool IsKnown() const {
+			return this->IsValid() && this->data_num > 0;
+		}
+
+		template <typename FeatType, typename LabelType>
+		void Add(const DataPoint<FeatType, LabelType> &data) {
+			this->data_num++;
+			this->nnz += data.indexes.size();
+			if (this->max_index < data.max_index){
+				this->max_index = data.max_index;
+			}
+			//labels beyond the capacity are not in the histogram
+			int32_t label = (int32_t)data.label;
+			for (uint32_t i = 0; i < this->class_num; ++i){
+				if (this->class_label[i] == label){
+					this->class_count[i]++;
+					return;
+				}
+			}
+			if (this->class_num < DATA_STATS_MAX_CLASS){
+				this->class_label[this->class_num] = label;
+				this->class_count[this->class_num] = 1;
+				this->class_num++;
+			}
+		}
+
+		void Print() const {
+			printf("Data number: %llu\n", (unsigned long long)this->data_num);
+			printf("Max index: %llu\n", (unsigned long long)this->max_index);
+			printf("Non-zero features: %llu (%.2f per example)\n", (unsigned long long)this->nnz,
+				this->data_num > 0 ? this->nnz / (double)this->data_num : 0.0);
+			printf("Class histogram:");
+			for (uint32_t i = 0; i < this->class_num; ++i){
+				printf(" %d:%llu", this->class_label[i], (unsigned long long)this->class_count[i]);
+			}
+			printf("\n");
+		}
+	};
+}
+
+#endif
@@ -43,6 +43,9 @@ namespace BOC{
 			}
 
 			void Push(PointType &srcPt){
+				if (this->max_index < srcPt.dim()){
+					this->max_index = srcPt.dim();
+				}
 				if (this->insert_pos == this->chunk_size){
 					this->insert_pos = 0;
 				}
@@ -71,6 +74,9 @@ namespace BOC{
 			}
 
 			void Push(PointType &srcPt){
+				if (this->max_index < srcPt.dim()){
+					this->max_index = srcPt.dim();
+				}
 				static size_t ret_id;
 				if (this->dataNum < this->chunk_size){
 					this->dataNum++;
@@ -99,6 +105,9 @@ namespace BOC{
 			}
 
 			void Push(PointType &srcPt){
+				if (this->max_index < srcPt.dim()){
+					this->max_index = srcPt.dim();
+				}
 				this->total_num++;
 				if (this->dataNum < this->chunk_size){ //less than the buffer
 					srcPt.clone(this->data[this->insert_pos]);
@@ -8,7 +8,9 @@
 #define HEADER_ONLINE_BUFFER
 
 #include "../utils/thread_primitive.h"
+#include "../utils/util.h"
 #include "DataChunk.h"
+#include "PipelineStats.h"
 
 #include <stdexcept>
 
@@ -36,6 +38,9 @@ namespace BOC {
 		CV data_available;
 		CV buffer_full;
 
+		//time of the stages and the waits, guarded by data_lock
+		PipelineStats stats;
+
 		/**
 		 * @Synopsis Constructors
 		 */
@@ -82,6 +87,8 @@ namespace BOC {
 			mutex_lock(&this->data_lock);
 			this->buf_size = buf_size;
 			this->chunk_size = chunk_size;
+			this->stats.buf_size = buf_size;
+			this->stats.chunk_size = chunk_size;
 
 			this->head = new ChunkType(chunk_size);
 			ChunkType *p = this->head;
@@ -166,6 +173,7 @@ namespace BOC {
 			this->wt_ptr = this->head;
 			this->rd_ptr = this->head;
 			this->is_on_loading = true;
+			this->stats.Reset();
 			mutex_unlock(&this->data_lock);
 
 			return true;
@@ -185,7 +193,10 @@ namespace BOC {
 				return *p;
 			}
 			else{
+				double wait_start = get_current_time();
 				condition_variable_wait(&this->buffer_full, &this->data_lock);
+				this->stats.write_wait_time += get_current_time() - wait_start;
+				this->stats.write_wait_num++;
 				mutex_unlock(&this->data_lock);
 				return this->GetWriteChunk();
 			}
@@ -193,20 +204,48 @@ namespace BOC {
 
 		/**
 		 * @Synopsis EndWriteChunk Finish writing a chunk
+		 *
+		 * @Param load_time seconds of reading and parsing the chunk
+		 * @Param cache_time seconds of writing the chunk to the cache
+		 * @Param process_time seconds of mapping and normalizing the chunk
 		 */
-		inline void EndWriteChunk(){
+		inline void EndWriteChunk(double load_time = 0, double cache_time = 0, double process_time = 0){
 			mutex_lock(&this->data_lock);
 			this->wt_ptr->is_parsed = true;
-			//if (this->wt_ptr->dataNum == 0){
-			//	cout<<"chunk size is zero!"<<endl;
-			//}
+			this->stats.chunk_num++;
+			this->stats.data_num += this->wt_ptr->dataNum;
+			this->stats.load_time += load_time;
+			this->stats.cache_time += cache_time;
+			this->stats.process_time += process_time;
 			this->wt_ptr = this->wt_ptr->next;
 			condition_variable_signal_all(&this->data_available);
-			//this->time2 = get_current_time();
-			//this->load_time += time2 - time1;
 			mutex_unlock(&this->data_lock);
 		}
 
+		/**
+		 * @Synopsis GetParsedNum number of the parsed chunks waiting to be
+		 * read, the buffer is full if it equals to the buffer size
+		 */
+		int GetParsedNum() {
+			mutex_lock(&this->data_lock);
+			int parsed_num = this->CountParsed();
+			mutex_unlock(&this->data_lock);
+			return parsed_num;
+		}
+
+		inline int GetBufferSize() const { return this->buf_size; }
+
+		/**
+		 * @Synopsis GetStats get the time of the loading stages and the waits
+		 * since the loading begins
+		 */
+		PipelineStats GetStats() {
+			mutex_lock(&this->data_lock);
+			PipelineStats ret = this->stats;
+			mutex_unlock(&this->data_lock);
+			return ret;
+		}
+
 		/**
 		 * @Synopsis FinishParse Finish loading the data
 		 */
@@ -228,6 +267,8 @@ namespace BOC {
 			mutex_lock(&this->data_lock);
 			//check if there is available data
 			if (this->rd_ptr->is_parsed == true){
+				this->stats.read_num++;
+				this->stats.parsed_sum += this->CountParsed();
 				this->rd_ptr->is_parsed = false;
 				ChunkType* p = this->rd_ptr;
 				mutex_unlock(&this->data_lock);
@@ -241,7 +282,10 @@ namespace BOC {
 					return *(this->rd_ptr); //return an invalid data
 				}
 				else{ //suspend the current thread
+					double wait_start = get_current_time();
 					condition_variable_wait(&this->data_available, &this->data_lock);
+					this->stats.read_wait_time += get_current_time() - wait_start;
+					this->stats.read_wait_num++;
 					mutex_unlock(&this->data_lock);
 					return this->GetChunk();
 				}
@@ -259,6 +303,18 @@ namespace BOC {
 			condition_variable_signal_all(&this->buffer_full);
 			mutex_unlock(&this->data_lock);
 		}
+
+	protected:
+		//number of the parsed chunks from the read location, called with the lock
+		int CountParsed() const {
+			int parsed_num = 0;
+			const ChunkType *p = this->rd_ptr;
+			for (int i = 0; p != NULL && i < this->buf_size && p->is_parsed == true; ++i){
+				parsed_num++;
+				p = p->next;
+			}
+			return parsed_num;
+		}
 	};
 }
 
@@ -14,6 +14,8 @@
 
 #include "DataSet.h"
 #include "../utils/Params.h"
+#include "../utils/feature_map.h"
+#include "../utils/sparse_kernel.h"
 
 #include <sstream>
 
@@ -31,6 +33,9 @@ namespace BOC {
 		int pass_num; //number of passes
 		OnlineBuffer<PointType> *online_buf;
 
+		int loader_cpu; //processor the loader is bound to, -1 if not bound
+		int loader_node; //numa node the loader allocates memory on, -1 if not set
+
 #if WIN32
 		HANDLE thread;
 #else
@@ -41,7 +46,7 @@ namespace BOC {
 		 */
 	public:
 		OnlineDataSet(int passes, bool is_norm, int buf_size, int chunk_size) :
-			online_buf(NULL), DataSet<FeatType, LabelType>() {
+			online_buf(NULL), loader_cpu(-1), loader_node(-1), DataSet<FeatType, LabelType>() {
 			if (passes < 1) {
 				std::ostringstream oss;
 				oss << "number of passes should be no less than 1, while " << passes << " is specified!";
@@ -69,6 +74,29 @@ namespace BOC {
 			}
 		}
 
+		/**
+		 * @Synopsis SetLoaderPlacement set where the loader thread runs and
+		 * allocates the parsed data
+		 *
+		 * @Param cpu processor to bind the loader to, -1 to leave it unbound
+		 * @Param node numa node to allocate the data on, -1 for the default policy
+		 */
+		void SetLoaderPlacement(int cpu, int node){
+			this->loader_cpu = cpu;
+			this->loader_node = node;
+		}
+
+	protected:
+		//called by the loader thread before loading
+		void PlaceLoader(){
+			if (this->loader_cpu >= 0 && bind_current_thread(this->loader_cpu) == false){
+				fprintf(stderr, "Warning: bind loader to cpu %d failed\n", this->loader_cpu);
+			}
+			if (this->loader_node >= 0 && set_preferred_node(this->loader_node) == false){
+				fprintf(stderr, "Warning: allocate loader memory on node %d failed\n", this->loader_node);
+			}
+		}
+
 	public:
 		/**
 		 * @Synopsis Load load data from an text data file or the cached file,
@@ -149,16 +177,54 @@ namespace BOC {
 
 		/**
 		 * @Synopsis EndWriteChunk Finish writing a chunk
+		 *
+		 * @Param chunk the loaded chunk
+		 * @Param load_time seconds of reading and parsing the chunk
+		 * @Param cache_time seconds of writing the chunk to the cache
 		 */
-		inline void EndWriteChunk(ChunkType& chunk){
+		inline void EndWriteChunk(ChunkType& chunk, double load_time = 0, double cache_time = 0){
+			double time1 = get_current_time();
+			//map the indexes to the weight slots
+			if (this->train_map != NULL){
+				if (this->train_map->enabled() == true){
+					for (size_t i = 0; i < chunk.dataNum; ++i){
+						this->train_map->lookup_point(chunk.data[i]);
+					}
+				}
+			}
+			else if (this->feat_map.enabled() == true){
+				for (size_t i = 0; i < chunk.dataNum; ++i){
+					this->feat_map.map_point(chunk.data[i], true);
+				}
+			}
 			//normalize the data
 			if (this->is_norm == true){
 				for (size_t i = 0; i < chunk.dataNum; ++i){
 					chunk.data[i].Normalize();
 				}
 			}
+			//check once whether the indexes can take the vector kernels
+			chunk.max_index = 0;
+			for (size_t i = 0; i < chunk.dataNum; ++i){
+				DataPoint<FeatType, LabelType> &pt = chunk.data[i];
+				pt.is_strict = sparse_is_strict(pt.indexes.begin, pt.indexes.size());
+				if (chunk.max_index < pt.dim()){
+					chunk.max_index = pt.dim();
+				}
+			}
 			this->data_num += chunk.dataNum;
-			this->online_buf->EndWriteChunk();
+			this->online_buf->EndWriteChunk(load_time, cache_time, get_current_time() - time1);
+		}
+
+		virtual int GetPassNum() const { return this->pass_num; }
+
+		virtual float GetBufferOccupancy() {
+			return this->online_buf->GetParsedNum() / (float)this->online_buf->GetBufferSize();
+		}
+
+		virtual bool GetPipelineStats(PipelineStats &stats) {
+			stats = this->online_buf->GetStats();
+			return true;
 		}
 
 		/**
@@ -22,6 +22,7 @@ namespace BOC{
 	template <typename T1, typename T2>
 	bool load_chunk(DataReader<T1, T2>* reader, FixSizeDataChunk<PtType >&chunk){
 		bool not_file_end = true;
+		size_t read_bytes = reader->GetReadBytes();
 		chunk.erase();
 		while (chunk.dataNum < chunk.chunk_size && not_file_end == true){
 			DataPoint<T1, T2> &data = chunk.data[chunk.dataNum];
@@ -31,6 +32,7 @@ namespace BOC{
 			else
 				break;
 		}
+		chunk.read_bytes = reader->GetReadBytes() - read_bytes;
 		return not_file_end;
 	}
 
@@ -123,12 +125,14 @@ namespace BOC{
 		bool not_file_end = false;
 		do {
 			FixSizeDataChunk<PtType> &chunk = dataset->GetWriteChunk();
+			double time1 = get_current_time();
 			not_file_end = load_chunk(reader, chunk);
-			if (save_chunk(writer, chunk) == false){
-				dataset->EndWriteChunk(chunk);
+			double time2 = get_current_time();
+			bool is_saved = save_chunk(writer, chunk);
+			dataset->EndWriteChunk(chunk, time2 - time1, get_current_time() - time2);
+			if (is_saved == false){
 				break;
 			}
-			dataset->EndWriteChunk(chunk);
 		} while (not_file_end == true);
 		if (reader->Good() && writer->Good())
 			return end_cache(&writer, dataset->cache_filename);
@@ -156,6 +160,7 @@ namespace BOC{
 	{
 		OnlineDataSet<T1, T2>* dataset = static_cast<OnlineDataSet<T1, T2>*>(param);
 		DataReader<T1, T2>* reader = dataset->reader;
+		dataset->PlaceLoader();
 
 		int pass = 0;
 		//if load dataset and cache the dataset
@@ -189,8 +194,9 @@ namespace BOC{
 				bool not_file_end = false;
 				do {
 					FixSizeDataChunk<PtType> &chunk = dataset->GetWriteChunk();
+					double time1 = get_current_time();
 					not_file_end = load_chunk(reader, chunk);
-					dataset->EndWriteChunk(chunk);
+					dataset->EndWriteChunk(chunk, get_current_time() - time1);
 				} while (not_file_end == true);
 				if (reader->Good() == false) {
 					cerr << "Load cached dataset failed!" << endl;
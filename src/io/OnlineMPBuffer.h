@@ -65,6 +65,8 @@ namespace BOC {
 			mutex_lock(&this->data_lock);
 			//check if there is available data
 			if (this->rd_ptr->is_parsed == true){
+				this->stats.read_num++;
+				this->stats.parsed_sum += this->CountParsed();
 				this->rd_ptr->is_parsed = false;
 				ChunkType * p = this->rd_ptr;
 				mutex_unlock(&this->data_lock);
@@ -79,7 +81,10 @@ namespace BOC {
 				}
 				else{ //suspend the current thread
 					if (this->p_MPChunk == NULL || this->p_MPChunk->dataNum == 0){
+						double wait_start = get_current_time();
 						condition_variable_wait(&this->data_available, &this->data_lock);
+						this->stats.read_wait_time += get_current_time() - wait_start;
+						this->stats.read_wait_num++;
 						mutex_unlock(&this->data_lock);
 						return this->GetChunk();
 					}
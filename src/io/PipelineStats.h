@@ -0,0 +1,89 @@
+/*************************************************************************
+	> File Name: PipelineStats.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 10:14:37 PM
+	> Functions: time spent by the stages of loading data and the waits
+	> between the loader and the learner
+	************************************************************************/
+#ifndef HEADER_PIPELINE_STATS
+#define HEADER_PIPELINE_STATS
+
+#include <cstdio>
+#include <cstddef>
+
+namespace BOC {
+	/**
+	 * The loader reads and parses the examples of a chunk, writes them to the
+	 * cache if caching, then maps and normalizes them. The learner waits if
+	 * no chunk is parsed, and the loader waits if all the chunks of the
+	 * buffer are still in use.
+	 */
+	struct PipelineStats {
+		//number of chunks in the buffer and examples in a chunk
+		int buf_size;
+		size_t chunk_size;
+
+		//chunks and examples written by the loader
+		size_t chunk_num;
+		size_t data_num;
+		//seconds of reading and parsing (decoding the cache)
+		double load_time;
+		//seconds of writing the cache
+		double cache_time;
+		//seconds of mapping and normalizing
+		double process_time;
+		//time and times the loader waits for a free chunk
+		double write_wait_time;
+		size_t write_wait_num;
+
+		//chunks read by the learner
+		size_t read_num;
+		//sum of the parsed chunks waiting when the learner reads a chunk
+		size_t parsed_sum;
+		//time and times the learner waits for a parsed chunk
+		double read_wait_time;
+		size_t read_wait_num;
+
+		PipelineStats() : buf_size(0), chunk_size(0) {
+			this->Reset();
+		}
+
+		void Reset() {
+			this->chunk_num = 0;
+			this->data_num = 0;
+			this->load_time = 0;
+			this->cache_time = 0;
+			this->process_time = 0;
+			this->write_wait_time = 0;
+			this->write_wait_num = 0;
+			this->read_num = 0;
+			this->parsed_sum = 0;
+			this->read_wait_time = 0;
+			this->read_wait_num = 0;
+		}
+
+		//fraction of the examples a chunk can hold that are filled
+		inline float FillRate() const {
+			return this->chunk_num == 0 ? 0 : this->data_num / ((float)this->chunk_num * this->chunk_size);
+		}
+
+		//average number of parsed chunks waiting when the learner reads a chunk
+		inline float AverageParsed() const {
+			return this->read_num == 0 ? 0 : this->parsed_sum / (float)this->read_num;
+		}
+
+		void Print() const {
+			printf("\nData pipeline:\n");
+			printf("\tLoader: read and parse %.3f s, cache %.3f s, map and normalize %.3f s\n",
+				this->load_time, this->cache_time, this->process_time);
+			printf("\tLoader waited for the learner: %.3f s (%lu times)\n",
+				this->write_wait_time, this->write_wait_num);
+			printf("\tLearner waited for the loader: %.3f s (%lu times)\n",
+				this->read_wait_time, this->read_wait_num);
+			printf("\tChunks: %lu, %.2f %% filled, %.2f of %d parsed when read\n",
+				this->chunk_num, this->FillRate() * 100, this->AverageParsed(), this->buf_size);
+		}
+	};
+}
+
+#endif
@@ -32,6 +32,7 @@ namespace BOC{
 			this->close_file();
 			return false;
 		}
+		this->read_bytes = 0;
 		return true;
 	}
 
@@ -77,7 +78,9 @@ namespace BOC{
 	 * @Return: true if succeed
 	 */
 	bool basic_io::read_data(char* dst, size_t length){
-		return fread(dst, 1, length, file) == length;
+		size_t read_len = fread(dst, 1, length, file);
+		this->read_bytes += read_len;
+		return read_len == length;
 	}
 
 	/**
@@ -99,6 +102,7 @@ namespace BOC{
 			if (fgets(dst + len, static_cast<int>(dst_len - len), file) == NULL)
 				break;
 		}
+		this->read_bytes += strlen(dst);
 		return dst;
 	}
 
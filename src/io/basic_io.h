@@ -15,9 +15,11 @@ namespace BOC{
 	class basic_io : public io_interface {
 	private:
 		FILE* file;
+		//number of bytes read since the file is opened
+		size_t read_bytes;
 
 	public:
-		basic_io() :file(NULL){}
+		basic_io() :file(NULL), read_bytes(0){}
 		virtual ~basic_io(){
 			this->close_file();
 		}
@@ -39,6 +41,8 @@ namespace BOC{
 		 */
 		virtual int good();
 
+		inline size_t get_read_bytes() const { return this->read_bytes; }
+
 	public:
 		/**
 		 * read_data : read the data from file
@@ -10,6 +10,7 @@
 
 
 #include "DataHandler.h"
+#include "DataStats.h"
 #include "basic_io.h"
 //#include "zlib_io.h"
 //#include "gzip_io.h"
@@ -36,9 +37,17 @@ namespace BOC {
 
 		bool is_good; //indicate if the current reader is good
 
+		//statistics in the header of the file, the header is filled when
+		//the writing file is closed; files without the header are still read
+		DataStats stats;
+		bool has_header;
+		bool is_writing;
+
 	public:
 		binary_io(const std::string &fileName) : DataHandler<FeatType, LabelType>(fileName){
 			this->is_good = true;
+			this->has_header = false;
+			this->is_writing = false;
 		}
 
 		~binary_io() {
@@ -53,27 +62,72 @@ namespace BOC {
 		bool OpenReading() {
 			this->Close();
 			this->is_good = io_handler.open_file(this->fileName.c_str(), "rb");
+			if (this->is_good == true){
+				this->ReadHeader();
+			}
 			return this->is_good;
 		}
 
 		bool OpenWriting() {
 			this->Close();
 			this->is_good = io_handler.open_file(this->fileName.c_str(), "wb");
+			if (this->is_good == true){
+				//the header is rewritten with the statistics when closed
+				this->stats.Reset();
+				this->is_good = io_handler.write_data((char*)&this->stats, sizeof(DataStats));
+				this->has_header = true;
+				this->is_writing = true;
+			}
 			return this->is_good;
 		}
 
 		void Rewind() {
 			io_handler.rewind();
+			if (this->has_header == true){
+				DataStats header;
+				io_handler.read_data((char*)&header, sizeof(DataStats));
+			}
 		}
 
 		void Close() {
+			if (this->is_writing == true){
+				if (this->Good() == true){
+					io_handler.rewind();
+					io_handler.write_data((char*)&this->stats, sizeof(DataStats));
+				}
+				this->is_writing = false;
+			}
 			io_handler.close_file();
 		}
 
+		/**
+		 * @Synopsis GetStats statistics in the header of the file
+		 *
+		 * @Returns NULL if the file has no header or writing did not finish
+		 */
+		const DataStats* GetStats() const {
+			return this->stats.IsKnown() ? &this->stats : NULL;
+		}
+
+	protected:
+		//read the header, or go back to the beginning for files without it
+		void ReadHeader() {
+			this->has_header = io_handler.read_data((char*)&this->stats, sizeof(DataStats)) &&
+				this->stats.IsValid();
+			if (this->has_header == false){
+				this->stats.Reset();
+				io_handler.rewind();
+			}
+		}
+
+	public:
+
 		inline bool Good() {
 			return this->is_good == true && io_handler.good() == 0 ? true : false;
 		}
 
+		virtual size_t GetReadBytes() const { return io_handler.get_read_bytes(); }
+
 		bool GetNextData(DataPoint<FeatType, LabelType> &data) {
 			data.erase();
 			if (io_handler.read_data((char*)&(data.label), sizeof(LabelType)) == false){
@@ -182,6 +236,7 @@ namespace BOC {
 					return false;
 				}
 			}
+			this->stats.Add(data);
 			return true;
 		}
 	};
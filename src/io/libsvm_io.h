@@ -89,6 +89,8 @@ namespace BOC {
 			return this->is_good == true && io_hander.good() == 0 ? true : false;
 		}
 
+		virtual size_t GetReadBytes() const { return io_hander.get_read_bytes(); }
+
 		virtual bool GetNextData(DataPoint<FeatType, LabelType> &data) {
 			if (io_hander.read_line(line, max_line_len) == NULL)
 				return false;
@@ -0,0 +1,109 @@
+/*************************************************************************
+	> File Name: FastLogisticLoss.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 6:12:27 PM
+	> Functions: Logistic loss for binary classification with approximate
+	> exp and log in single precision
+	************************************************************************/
+
+#ifndef HEADER_FAST_LOGISTIC_FUNCTIONS
+#define HEADER_FAST_LOGISTIC_FUNCTIONS
+#include "LossFunction.h"
+
+#include <stdint.h>
+#include <cstring>
+
+namespace BOC {
+	/**
+	 * @Synopsis fast_exp exp(x) in float, the relative error is below 3e-7
+	 * for x in [-87, 88], and x is clamped to the range. 2^n * exp(r) with
+	 * |r| <= ln2 / 2, where exp(r) is a polynomial of degree 6. There is no
+	 * branch, so that loops over arrays can be vectorized.
+	 */
+	inline float fast_exp(float x) {
+		x = x < -87.f ? -87.f : x;
+		x = x > 88.f ? 88.f : x;
+		float n = (float)(int)(x * 1.44269504f + (x < 0 ? -0.5f : 0.5f));
+		//ln2 in two parts, so that r is exact
+		float r = x - n * 0.693145752f - n * 1.42860677e-6f;
+		float p = 1.f + r * (1.f + r * (0.5f + r * (0.166666672f + r * (0.0416666679f +
+			r * (0.00833333377f + r * 0.00138888892f)))));
+		uint32_t bits = (uint32_t)((int)n + 127) << 23;
+		float scale;
+		std::memcpy(&scale, &bits, sizeof(scale));
+		return p * scale;
+	}
+
+	/**
+	 * @Synopsis fast_log log(x) in float for normal positive x, the error is
+	 * below 1.5e-7, absolute if |log(x)| < 1 and relative otherwise.
+	 * x = 2^e * m with m in [sqrt(0.5), sqrt(2)), and log(m) is
+	 * 2 * atanh((m - 1) / (m + 1)) by its series to the 9th power.
+	 */
+	inline float fast_log(float x) {
+		uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		//0x3F3504F3 is sqrt(0.5)
+		int e = (int32_t)(bits - 0x3F3504F3u) >> 23;
+		bits -= (uint32_t)e << 23;
+		float m;
+		std::memcpy(&m, &bits, sizeof(m));
+		float s = (m - 1.f) / (m + 1.f);
+		float s2 = s * s;
+		float log_m = 2.f * s * (1.f + s2 * (0.333333343f + s2 * (0.2f + s2 * (0.142857149f +
+			s2 * 0.111111112f))));
+		return log_m + (float)e * 0.693147182f;
+	}
+
+	/**
+	 * @Synopsis fast_log1p_exp log(1 + exp(x)) without overflow, the error is
+	 * below 1.5e-7, absolute if the result is below 1 and relative otherwise
+	 */
+	inline float fast_log1p_exp(float x) {
+		float pos = x > 0 ? x : 0;
+		float neg = x > 0 ? -x : x;
+		return pos + fast_log(1.f + fast_exp(neg));
+	}
+
+	template <typename FeatType, typename LabelType>
+	class FastLogisticLoss : public LossFunction<FeatType, LabelType> {
+		//for dynamic binding
+		DECLARE_CLASS
+
+	public:
+		FastLogisticLoss() :
+			LossFunction<FeatType, LabelType>(BC_LOSS_TYPE){}
+
+	public:
+		virtual void GetLoss(LabelType label, float *predict, float* loss, int len) {
+			*loss = fast_log1p_exp(-*predict * label);
+		}
+
+		virtual void GetGradient(LabelType label, float* predict, float* gradient, float* classifier_weight, int len) {
+			*gradient = Gradient(label, *predict);
+		}
+
+		/**
+		 * @Synopsis GetGradients gradients of a mini-batch in one loop,
+		 * which is vectorized as there is no branch
+		 */
+		virtual void GetGradients(const LabelType* labels, const float* predicts, float* gradients, size_t num) {
+			for (size_t i = 0; i < num; ++i){
+				gradients[i] = Gradient(labels[i], predicts[i]);
+			}
+		}
+
+		//gradient known at compile time, used by the specialized training loops
+		inline static float Gradient(LabelType label, float predict) {
+			//the relative error is below 3e-7, the gradient is 0 where exp
+			//overflows, so that the update is skipped as with exp
+			float tmp = predict * label;
+			float gradient = -label / (1.f + fast_exp(tmp));
+			return tmp < 88.f ? gradient : 0.f;
+		}
+	};
+	//for dynamic binding
+	IMPLEMENT_LOSS_CLASS(FastLogisticLoss, FastLogistic)
+}
+
+#endif
@@ -26,14 +26,15 @@ namespace BOC {
 		}
 
 		virtual  void GetGradient(LabelType label, float *predict, float* gradient, float* classifier_weight, int len) {
-			float loss = 0;
-			this->GetLoss(label, predict, &loss, len);
-			if (loss > 0){
-				*gradient = (float)(-label);
-			}
-			else{
-				*gradient = 0;
+			*gradient = Gradient(label, *predict);
+		}
+
+		//gradient known at compile time, used by the specialized training loops
+		inline static float Gradient(LabelType label, float predict) {
+			if (1.f - predict * label > 0){
+				return (float)(-label);
 			}
+			return 0;
 		}
 	};
 
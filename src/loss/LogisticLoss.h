@@ -35,16 +35,21 @@ namespace BOC {
 
 		//aggressive learning 
 		virtual void GetGradient(LabelType label, float* predict, float* gradient, float* classifier_weight, int len) {
-			float tmp = *predict * label;
+			*gradient = Gradient(label, *predict);
+		}
+
+		//gradient known at compile time, used by the specialized training loops
+		inline static float Gradient(LabelType label, float predict) {
+			float tmp = predict * label;
 			//to reject numeric problems
 			if (tmp > 100.f) {
-				*gradient = 0.f;
+				return 0.f;
 			}
 			else if (tmp < -100.f){
-				*gradient = -(float)(label);
+				return -(float)(label);
 			}
 			else{
-				*gradient = -label / (1.f + exp(tmp));
+				return -label / (1.f + exp(tmp));
 			}
 		}
 	};
@@ -51,6 +51,21 @@ namespace BOC {
 		virtual void GetLoss(LabelType label, float* predict, float* loss, int len = 1) = 0;
 		virtual void GetGradient(LabelType label, float* predict, float* gradient, float* classifier_weight = NULL, int len = 1) = 0;
 
+		/**
+		 * @Synopsis GetGradients gradients of the examples of a mini-batch in
+		 * binary classification, one by one by default
+		 *
+		 * @Param labels labels of the examples
+		 * @Param predicts predicted values of the examples
+		 * @Param gradients gradients of the examples
+		 * @Param num number of examples
+		 */
+		virtual void GetGradients(const LabelType* labels, const float* predicts, float* gradients, size_t num) {
+			for (size_t i = 0; i < num; ++i){
+				this->GetGradient(labels[i], const_cast<float*>(predicts + i), gradients + i);
+			}
+		}
+
 	public:
 		virtual ~LossFunction(){}
 	};
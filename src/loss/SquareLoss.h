@@ -27,7 +27,12 @@ namespace BOC {
 		}
 
 		virtual void GetGradient(LabelType label, float* predict, float* gradient, float* classifier_weight, int len) {
-			*gradient = 2 * (*predict - label);
+			*gradient = Gradient(label, *predict);
+		}
+
+		//gradient known at compile time, used by the specialized training loops
+		inline static float Gradient(LabelType label, float predict) {
+			return 2 * (predict - label);
 		}
 	};
 	//for dynamic binding
@@ -26,13 +26,16 @@ namespace BOC {
 		}
 
 		virtual  void GetGradient(LabelType label, float* predict, float* gradient, float* classifier_weight,  int len) {
-			float loss = max(0.0f, 1.f - *predict * label);
+			*gradient = Gradient(label, *predict);
+		}
+
+		//gradient known at compile time, used by the specialized training loops
+		inline static float Gradient(LabelType label, float predict) {
+			float loss = max(0.0f, 1.f - predict * label);
 			if (loss > 0){
-				*gradient = -label * loss * 2.f;
-			}
-			else{
-				*gradient = 0;
+				return -label * loss * 2.f;
 			}
+			return 0;
 		}
 	};
 
@@ -2,6 +2,7 @@
 #define HEADER_SOL_LOSS
 
 #include "LogisticLoss.h"
+#include "FastLogisticLoss.h"
 #include "HingeLoss.h"
 #include "SquareLoss.h"
 #include "SquaredHingeLoss.h"
@@ -18,6 +19,7 @@ namespace BOC{
             info.append("\nLoss Functions:");
             APPEND_INFO(info, HingeLoss, FeatType, LabelType);
             APPEND_INFO(info, LogisticLoss, FeatType, LabelType);
+            APPEND_INFO(info, FastLogisticLoss, FeatType, LabelType);
             APPEND_INFO(info, SquareLoss, FeatType, LabelType);
             APPEND_INFO(info, SquaredHingeLoss, FeatType, LabelType);
             APPEND_INFO(info, MaxScoreHingeLoss, FeatType, LabelType);
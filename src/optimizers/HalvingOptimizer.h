@@ -0,0 +1,150 @@
+/*************************************************************************
+	> File Name: HalvingOptimizer.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 4:02:47 PM
+	> Functions: successive halving over models with different settings
+	************************************************************************/
+#ifndef HEADER_HALVING_OPTIMIZER
+#define HEADER_HALVING_OPTIMIZER
+
+#include "MultiOptimizer.h"
+
+#include <algorithm>
+
+/**
+*  namespace: Batch and Online Classification
+*/
+namespace BOC {
+	template <typename FeatType, typename LabelType>
+	class HalvingOptimizer : public MultiOptimizer < FeatType, LabelType > {
+
+		//dynamic bindings
+		DECLARE_CLASS
+
+	protected:
+		typedef typename MultiOptimizer<FeatType, LabelType>::SlotType SlotType;
+
+	protected:
+		//number of examples of the first rung
+		size_t init_budget;
+		//number of examples of the current rung
+		size_t budget;
+		//number of examples processed when the current rung starts
+		size_t rung_start;
+		//index of the current rung
+		int rung_id;
+		//number of mistakes and examples of each model when the current rung starts
+		vector<size_t> rung_errorNum;
+		vector<size_t> rung_dataNum;
+
+		/**
+		 * @Synopsis Constructors
+		 */
+	public:
+		HalvingOptimizer(OnlineModel<FeatType, LabelType> *model, DataSet<FeatType, LabelType> *dataset) :
+			MultiOptimizer<FeatType, LabelType>(model, dataset), init_budget(init_halving_budget),
+			budget(0), rung_start(0), rung_id(0){
+		}
+
+		virtual ~HalvingOptimizer() {
+		}
+
+		/**
+		 * @Synopsis inherited functions
+		 */
+	public:
+		/**
+		 * @Synopsis SetParameter set parameters for the optimizer
+		 *
+		 */
+		virtual void SetParameter(BOC::Params &param){
+			MultiOptimizer<FeatType, LabelType>::SetParameter(param);
+			int budget = param.IntValue("-budget");
+			INVALID_ARGUMENT_EXCEPTION(budget, budget > 0, "larger than 0");
+			this->init_budget = budget;
+		}
+
+		//train the data
+		virtual float Train() {
+			this->budget = this->init_budget;
+			this->rung_start = 0;
+			this->rung_id = 0;
+			this->rung_errorNum.assign(this->slots.size(), 0);
+			this->rung_dataNum.assign(this->slots.size(), 0);
+
+			float errRate = MultiOptimizer<FeatType, LabelType>::Train();
+
+			double total_time = 0;
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				total_time += this->slots[i]->train_time;
+			}
+			printf("Accumulated training time of all models: %.3f s\n", total_time);
+			return errRate;
+		}
+
+	protected:
+		/**
+		 * @Synopsis EndChunk keep the better half of the settings when the budget
+		 * of the current rung is used up. In cross validation, a setting is
+		 * ranked by the mean error of its folds, and its folds are kept or
+		 * stopped together, so that the held-out errors of the kept settings
+		 * are all from the same examples.
+		 *
+		 * @Param data_count number of examples processed
+		 */
+		virtual void EndChunk(size_t data_count){
+			if (data_count - this->rung_start < this->budget){
+				return;
+			}
+			//the folds of a setting are placed together
+			size_t group_size = this->fold_num > 1 ? this->fold_num : 1;
+			//progressive validation error of each setting on the current rung
+			vector<std::pair<float, size_t> > rung_errors;
+			for (size_t i = 0; i + group_size <= this->slots.size(); i += group_size){
+				if (this->slots[i]->is_active == false){
+					continue;
+				}
+				float err = 0;
+				for (size_t k = i; k < i + group_size; ++k){
+					SlotType &slot = *this->slots[k];
+					size_t rung_dataNum = slot.dataNum - this->rung_dataNum[k];
+					err += rung_dataNum == 0 ? 1.f : (slot.errorNum - this->rung_errorNum[k]) / (float)rung_dataNum;
+					this->rung_errorNum[k] = slot.errorNum;
+					this->rung_dataNum[k] = slot.dataNum;
+				}
+				rung_errors.push_back(std::make_pair(err / group_size, i));
+			}
+			if (rung_errors.size() <= 1){
+				return;
+			}
+
+			std::sort(rung_errors.begin(), rung_errors.end());
+			size_t keep_num = (rung_errors.size() + 1) / 2;
+			for (size_t i = keep_num; i < rung_errors.size(); ++i){
+				for (size_t k = 0; k < group_size; ++k){
+					this->slots[rung_errors[i].second + k]->is_active = false;
+				}
+			}
+			const string& name = this->slots[rung_errors[0].second]->name;
+			printf("rung %d: %lu examples, keep %lu of %lu settings, best %s (%.6f)\n",
+				this->rung_id, data_count - this->rung_start, keep_num, rung_errors.size(),
+				(group_size > 1 ? name.substr(0, name.rfind('#')) : name).c_str(), rung_errors[0].first);
+
+			this->rung_id++;
+			this->rung_start = data_count;
+			this->budget *= 2;
+		}
+	};
+
+	template <typename FeatType, typename LabelType>
+	ClassInfo HalvingOptimizer<FeatType, LabelType>::classInfo("opt_halving",
+		"successive halving over models with different settings", HalvingOptimizer<FeatType, LabelType>::CreateObject);
+
+	template <typename FeatType, typename LabelType>
+	void* HalvingOptimizer<FeatType, LabelType>::CreateObject(void* model, void* dataset, void* param3) {
+		return new HalvingOptimizer<FeatType, LabelType>((OnlineModel<FeatType, LabelType>*)model,
+			(DataSet<FeatType, LabelType>*)dataset);
+	}
+}
+
+#endif
@@ -0,0 +1,777 @@
+/*************************************************************************
+	> File Name: MultiOptimizer.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 2:15:32 PM
+	> Functions: train multiple online models with different settings in one pass
+	************************************************************************/
+#ifndef HEADER_MULTI_OPTIMIZER
+#define HEADER_MULTI_OPTIMIZER
+
+#include "Optimizer.h"
+#include "../algorithms/om/OnlineModel.h"
+#include "../utils/thread_primitive.h"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <sstream>
+#include <stdint.h>
+
+/**
+*  namespace: Batch and Online Classification
+*/
+namespace BOC {
+	/**
+	 * @Synopsis a model trained by the multi-model optimizer
+	 */
+	template <typename FeatType, typename LabelType>
+	struct ModelSlot {
+		OnlineModel<FeatType, LabelType> *model;
+		LossFunction<FeatType, LabelType> *lossFunc;
+		//name of the model and its settings
+		std::string name;
+		//number of mistakes and examples in training
+		size_t errorNum;
+		size_t dataNum;
+		//time cost of training
+		double train_time;
+		//whether the model is still trained
+		bool is_active;
+		//held-out fold in cross validation, -1 if all the examples are trained
+		int fold_id;
+		//number of mistakes and examples on the held-out fold
+		size_t heldout_errorNum;
+		size_t heldout_dataNum;
+		//number of mistakes and examples in test
+		size_t test_errorNum;
+		size_t test_dataNum;
+		//metrics of training, the held-out fold and test, empty if not evaluated
+		eval_metrics train_metrics;
+		eval_metrics heldout_metrics;
+		eval_metrics test_metrics;
+		//predicted values of each classifier
+		s_array<float> predicts;
+
+		ModelSlot() : model(NULL), lossFunc(NULL), errorNum(0), dataNum(0),
+			train_time(0), is_active(true), fold_id(-1), heldout_errorNum(0), heldout_dataNum(0),
+			test_errorNum(0), test_dataNum(0) {
+		}
+
+		~ModelSlot() {
+			DELETE_POINTER(this->model);
+			DELETE_POINTER(this->lossFunc);
+		}
+
+		inline float ErrorRate() const {
+			return this->dataNum == 0 ? 1.f : this->errorNum / (float)(this->dataNum);
+		}
+
+		inline float TestErrorRate() const {
+			return this->test_dataNum == 0 ? 1.f : this->test_errorNum / (float)(this->test_dataNum);
+		}
+
+		inline float HeldoutErrorRate() const {
+			return this->heldout_dataNum == 0 ? 1.f : this->heldout_errorNum / (float)(this->heldout_dataNum);
+		}
+	};
+
+	template <typename FeatType, typename LabelType>
+	class MultiOptimizer : public Optimizer < FeatType, LabelType > {
+
+		//dynamic bindings
+		DECLARE_CLASS
+
+	protected:
+		typedef typename Optimizer<FeatType, LabelType>::PointType PointType;
+		typedef ModelSlot<FeatType, LabelType> SlotType;
+
+		struct WorkerParam {
+			MultiOptimizer<FeatType, LabelType> *optimizer;
+			int thread_id;
+		};
+
+	protected:
+		//models trained on the same chunks
+		vector<SlotType*> slots;
+		//number of threads, including the main thread
+		int thread_num;
+		//number of folds in cross validation, no cross validation if smaller than 2
+		int fold_num;
+		//fold of each example in the current chunk
+		vector<int> chunk_folds;
+
+		//workers
+		vector<THREAD> threads;
+		vector<WorkerParam> worker_params;
+		MUTEX task_lock;
+		CV task_ready;
+		CV task_done;
+		//chunk shared by the workers, read only in training
+		const DataChunk<PointType> *cur_chunk;
+		//id of the current task, increased with every chunk
+		size_t task_id;
+		//next slot to be trained on the current chunk
+		size_t next_slot;
+		//number of workers that are still training on the current chunk
+		int pending_num;
+		bool is_stop;
+		//whether the models are tested rather than trained on the chunks
+		bool is_testing;
+		//output stream of the predictions of the best model in test
+		std::ostream* pred_os;
+
+		/**
+		 * @Synopsis Constructors
+		 */
+	public:
+		MultiOptimizer(OnlineModel<FeatType, LabelType> *model, DataSet<FeatType, LabelType> *dataset) :
+			Optimizer<FeatType, LabelType>(model, dataset), thread_num(1), fold_num(0), cur_chunk(NULL),
+			task_id(0), next_slot(0), pending_num(0), is_stop(false), is_testing(false), pred_os(NULL){
+			initialize_mutex(&this->task_lock);
+			initialize_condition_variable(&this->task_ready);
+			initialize_condition_variable(&this->task_done);
+		}
+
+		virtual ~MultiOptimizer() {
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				DELETE_POINTER(this->slots[i]);
+			}
+			delete_mutex(&this->task_lock);
+		}
+
+		/**
+		 * @Synopsis inherited functions
+		 */
+	public:
+		/**
+		 * @Synopsis SetParameter create a model for each setting in the
+		 * parameter grid
+		 *
+		 */
+		virtual void SetParameter(BOC::Params &param){
+			Optimizer<FeatType, LabelType>::SetParameter(param);
+			vector<vector<std::pair<string, string> > > settings;
+			this->ParseGrid(param.StringValue("-grid"), settings);
+			vector<string> model_types;
+			std::istringstream iss(param.StringValue("-m"));
+			string model_type;
+			while (getline(iss, model_type, ',')){
+				if (model_type.length() > 0){
+					model_types.push_back(model_type);
+				}
+			}
+
+			this->fold_num = param.IntValue("-cv");
+			INVALID_ARGUMENT_EXCEPTION(fold_num, this->fold_num != 1, "0 (no cross validation) or larger than 1");
+			//the folds of a setting are placed together
+			for (size_t m = 0; m < model_types.size(); ++m){
+				for (size_t i = 0; i < settings.size(); ++i){
+					if (this->fold_num > 1){
+						for (int k = 0; k < this->fold_num; ++k){
+							this->AddSlot(param, model_types[m], settings[i])->fold_id = k;
+						}
+					}
+					else{
+						this->AddSlot(param, model_types[m], settings[i]);
+					}
+				}
+			}
+
+			this->thread_num = param.IntValue("-threads");
+			if (this->thread_num <= 0){
+				this->thread_num = get_cpu_num();
+			}
+			if (this->thread_num > (int)(this->slots.size())){
+				this->thread_num = (int)(this->slots.size());
+			}
+		}
+
+		//train the data
+		virtual float Train() {
+			//reset
+			if (this->Reset() == false)
+				return 1.f;
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				SlotType &slot = *this->slots[i];
+				slot.model->BeginTrain();
+				slot.model->UpdateModelDimention(this->DataDim());
+				slot.errorNum = 0;
+				slot.dataNum = 0;
+				slot.train_time = 0;
+				slot.is_active = true;
+				slot.heldout_errorNum = 0;
+				slot.heldout_dataNum = 0;
+				if (this->is_eval == true){
+					slot.train_metrics.Reset(slot.model->GetClassfierNum());
+					if (slot.fold_id >= 0){
+						slot.heldout_metrics.Reset(slot.model->GetClassfierNum());
+					}
+				}
+			}
+
+			size_t show_step = 1; //show information every show_step
+			size_t show_count = 2;
+			size_t data_count = 0;
+
+			printf("\nIterations:\n");
+			printf("\nIterate No.\t\tBest Error Rate\t\t\n");
+
+			this->StartWorkers();
+			while (1) {
+				DataChunk<PointType> &chunk = this->dataSet->GetChunk();
+				//all the data has been processed!
+				if (chunk.dataNum == 0) {
+					this->dataSet->FinishRead();
+					break;
+				}
+				for (size_t i = 0; i < chunk.dataNum; i++) {
+					this->FilterFeatures(chunk.data[i]);
+				}
+				if (this->fold_num > 1){
+					this->chunk_folds.resize(chunk.dataNum);
+					for (size_t i = 0; i < chunk.dataNum; i++) {
+						this->chunk_folds[i] = (int)(this->HashData(chunk.data[i]) % this->fold_num);
+					}
+				}
+
+				//the chunk is released after all the models are trained on it
+				this->DispatchChunk(chunk);
+
+				data_count += chunk.dataNum;
+				this->update_times += chunk.dataNum;
+				this->EndChunk(data_count);
+				if (show_count <= data_count){
+					this->PrintProgress(data_count, this->GetBestSlot()->ErrorRate());
+					while (show_count <= data_count){
+						show_count = (size_t(1) << ++show_step);
+					}
+				}
+				this->dataSet->FinishRead();
+			}
+			this->StopWorkers();
+
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				this->slots[i]->model->EndTrain();
+			}
+
+			this->PrintSlots();
+
+			if (this->fold_num > 1){
+				return this->CrossValidate();
+			}
+			SlotType* best_slot = this->GetBestSlot();
+			this->learnModel = best_slot->model;
+			if (this->is_eval == true){
+				this->train_metrics.Reset(best_slot->model->GetClassfierNum());
+				this->train_metrics.Merge(best_slot->train_metrics);
+			}
+			printf("\nBest setting: %s\n", best_slot->name.c_str());
+			return best_slot->ErrorRate();
+		}
+
+		/**
+		 * @Synopsis Test test all the trained models on the given set
+		 *
+		 * @Param testSet
+		 *
+		 * @Returns error rate of the best model
+		 */
+		virtual float Test(DataSet<FeatType, LabelType> &testSet) {
+			return this->TestSlots(testSet, NULL);
+		}
+
+		/**
+		 * @Synopsis Test test all the trained models on the given set
+		 *
+		 * @Param testSet
+		 * @Param os output stream to save the predicted values of the best model
+		 *
+		 * @Returns error rate of the best model
+		 */
+		virtual float Test(DataSet<FeatType, LabelType> &testSet, std::ostream& os) {
+			return this->TestSlots(testSet, &os);
+		}
+
+		/**
+		 * @Synopsis SaveModel save the best model to the file, and each model to
+		 * the file with the name of the model as suffix
+		 *
+		 * @Param filename  name to the saved file
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModel(const string& filename){
+			bool ret = this->learnModel->SaveModel(filename);
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				const string& name = this->slots[i]->name;
+				string suffix(name.length(), '_');
+				for (size_t j = 0; j < name.length(); ++j){
+					if (isalnum(name[j]) || name[j] == '.' || name[j] == '-'){
+						suffix[j] = name[j];
+					}
+					else if (name[j] == '='){
+						suffix[j] = '-';
+					}
+				}
+				ret = this->slots[i]->model->SaveModel(filename + "." + suffix) && ret;
+			}
+			return ret;
+		}
+
+	protected:
+		/**
+		 * @Synopsis TestSlots test all the active models on the given set in one pass
+		 *
+		 * @Param testSet
+		 * @Param os output stream to save the predicted values of the best model
+		 *
+		 * @Returns error rate of the best model
+		 */
+		float TestSlots(DataSet<FeatType, LabelType> &testSet, std::ostream* os){
+			testSet.Rewind();
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				this->slots[i]->test_errorNum = 0;
+				this->slots[i]->test_dataNum = 0;
+				if (this->is_eval == true){
+					this->slots[i]->test_metrics.Reset(this->slots[i]->model->GetClassfierNum());
+				}
+				if (this->slots[i]->is_active == true){
+					this->slots[i]->model->Freeze();
+				}
+			}
+			this->is_testing = true;
+			this->pred_os = os;
+			this->StartWorkers();
+			while (1) {
+				const DataChunk<PointType> &chunk = testSet.GetChunk();
+				if (chunk.dataNum == 0) //"all the data has been processed!"
+					break;
+				this->DispatchChunk(chunk);
+				testSet.FinishRead();
+			}
+			this->StopWorkers();
+			this->is_testing = false;
+			this->pred_os = NULL;
+
+			float errorRate = 1.f;
+			printf("\n%-48s\tTest Error Rate\n", "Model");
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				const SlotType &slot = *this->slots[i];
+				if (slot.is_active == false){
+					continue;
+				}
+				printf("%-48s\t%.2f %%\n", slot.name.c_str(), slot.TestErrorRate() * 100);
+				if (slot.model == this->learnModel){
+					errorRate = slot.TestErrorRate();
+					if (this->is_eval == true){
+						this->test_metrics.Reset(slot.model->GetClassfierNum());
+						this->test_metrics.Merge(slot.test_metrics);
+					}
+				}
+			}
+			printf("\n");
+			return errorRate;
+		}
+
+		/**
+		 * @Synopsis TestSlot test a model on a chunk
+		 *
+		 * @Param slot model to be tested
+		 * @Param chunk shared chunk of data
+		 */
+		void TestSlot(SlotType &slot, const DataChunk<PointType> &chunk){
+			std::ostream* os = slot.model == this->learnModel ? this->pred_os : NULL;
+			for (size_t i = 0; i < chunk.dataNum; i++) {
+				const PointType &data = chunk.data[i];
+				int predict = slot.model->Predict(data, slot.predicts.begin);
+				if (os != NULL){
+					*os << predict << "\t" << (int)(data.label) << "\n";
+				}
+				if (this->is_eval == true){
+					slot.test_metrics.Add(data.label, slot.predicts.begin, predict);
+				}
+				if (predict != data.label){
+					slot.test_errorNum++;
+				}
+			}
+			slot.test_dataNum += chunk.dataNum;
+		}
+
+		/**
+		 * @Synopsis ParseGrid parse the parameter grid, like "eta=1,2;l1=1e-4,1e-3"
+		 *
+		 * @Param grid grid of parameters
+		 * @Param settings cross product of the values, each is a list of (flag, value)
+		 */
+		void ParseGrid(const string& grid, vector<vector<std::pair<string, string> > > &settings){
+			settings.clear();
+			settings.push_back(vector<std::pair<string, string> >());
+
+			std::istringstream iss(grid);
+			string item;
+			while (getline(iss, item, ';')){
+				size_t pos = item.find('=');
+				if (pos == string::npos || pos == 0 || pos + 1 == item.length()){
+					throw invalid_argument("invalid parameter grid: " + item);
+				}
+				string flag = item.substr(0, pos);
+				if (flag[0] != '-'){
+					flag = "-" + flag;
+				}
+				vector<vector<std::pair<string, string> > > new_settings;
+				std::istringstream vss(item.substr(pos + 1));
+				string value;
+				while (getline(vss, value, ',')){
+					for (size_t i = 0; i < settings.size(); ++i){
+						new_settings.push_back(settings[i]);
+						new_settings.back().push_back(std::make_pair(flag, value));
+					}
+				}
+				settings.swap(new_settings);
+			}
+		}
+
+		/**
+		 * @Synopsis AddSlot create a new model with the given setting
+		 *
+		 * @Param param parsed parameters
+		 * @Param model_type name of the model, with an optional loss function like "DAROW:SquaredHinge"
+		 * @Param setting list of (flag, value) overriding the parsed parameters
+		 *
+		 * @Returns the new slot
+		 */
+		SlotType* AddSlot(BOC::Params &param, const string& model_type,
+			const vector<std::pair<string, string> >& setting){
+			SlotType* slot = new SlotType;
+			this->slots.push_back(slot);
+
+			string model_name = model_type;
+			string loss_type = param.StringValue("-loss");
+			size_t pos = model_type.find(':');
+			if (pos != string::npos){
+				model_name = model_type.substr(0, pos);
+				loss_type = model_type.substr(pos + 1);
+			}
+
+			slot->lossFunc = (LossFunction<FeatType, LabelType>*)Registry::CreateObject(loss_type);
+			if (slot->lossFunc == NULL){
+				throw invalid_argument("init loss function failed: " + loss_type);
+			}
+			slot->model = (OnlineModel<FeatType, LabelType>*)Registry::CreateObject(model_name,
+				slot->lossFunc, (void*)(size_t)(param.IntValue("-cn")));
+			if (slot->model == NULL){
+				throw invalid_argument("init online model failed: " + model_name);
+			}
+			slot->model->SetFeatureMap(&this->dataSet->GetFeatureMap());
+
+			//override the parsed parameters, and restore them after the model is set
+			slot->name = model_type;
+			vector<string> old_values(setting.size());
+			for (size_t i = 0; i < setting.size(); ++i){
+				old_values[i] = param.ValueString(setting[i].first);
+				if (param.SetValue(setting[i].first, setting[i].second) == false){
+					throw invalid_argument("invalid setting: " + setting[i].first + "=" + setting[i].second);
+				}
+				slot->name += (i == 0 ? "[" : ",") + setting[i].first.substr(1) + "=" + setting[i].second;
+			}
+			if (setting.size() > 0){
+				slot->name += "]";
+			}
+			if (this->fold_num > 1){
+				std::ostringstream oss;
+				oss << "#" << (this->slots.size() - 1) % this->fold_num;
+				slot->name += oss.str();
+			}
+			slot->model->SetParameter(param);
+			for (size_t i = 0; i < setting.size(); ++i){
+				param.SetValue(setting[i].first, old_values[i]);
+			}
+
+			slot->predicts.resize(slot->model->GetClassfierNum());
+			return slot;
+		}
+
+		/**
+		 * @Synopsis TrainSlot train a model on a chunk
+		 *
+		 * @Param slot model to be trained
+		 * @Param chunk shared chunk of data
+		 */
+		virtual void TrainSlot(SlotType &slot, const DataChunk<PointType> &chunk){
+			OnlineModel<FeatType, LabelType> *model = slot.model;
+			bool is_bc = model->GetClassfierNum() == 1;
+			model->UpdateModelDimention(chunk.max_index);
+			for (size_t i = 0; i < chunk.dataNum; i++) {
+				const PointType &data = chunk.data[i];
+				//score the held-out examples with the current model
+				if (slot.fold_id >= 0 && this->chunk_folds[i] == slot.fold_id){
+					int predictLabel = model->Predict(data, slot.predicts.begin);
+					if (predictLabel != data.label){
+						slot.heldout_errorNum++;
+					}
+					if (this->is_eval == true){
+						slot.heldout_metrics.Add(data.label, slot.predicts.begin, predictLabel);
+					}
+					slot.heldout_dataNum++;
+					continue;
+				}
+				int predictLabel = is_bc ? model->IterateBC(data, slot.predicts.begin) :
+					model->IterateMC(data, slot.predicts.begin);
+				if (predictLabel != data.label){
+					slot.errorNum++;
+				}
+				if (this->is_eval == true){
+					slot.train_metrics.Add(data.label, slot.predicts.begin, predictLabel);
+				}
+				slot.dataNum++;
+			}
+		}
+
+		/**
+		 * @Synopsis HashData hash the content of an example, so that it is
+		 * assigned to the same fold in every pass
+		 *
+		 * @Param data input data sample
+		 *
+		 * @Returns hash value of the example (FNV-1a)
+		 */
+		static size_t HashData(const PointType &data){
+			uint32_t hash = 2166136261U;
+			const unsigned char* p = (const unsigned char*)(data.indexes.begin);
+			const unsigned char* p_end = (const unsigned char*)(data.indexes.end);
+			for (; p != p_end; ++p){
+				hash = (hash ^ *p) * 16777619U;
+			}
+			p = (const unsigned char*)(data.features.begin);
+			p_end = (const unsigned char*)(data.features.end);
+			for (; p != p_end; ++p){
+				hash = (hash ^ *p) * 16777619U;
+			}
+			hash = (hash ^ (unsigned char)(data.label)) * 16777619U;
+			return hash;
+		}
+
+		/**
+		 * @Synopsis CrossValidate summarize the held-out errors of each setting
+		 * and select the best one, settings stopped early by opt_halving are
+		 * not compared as their folds are trained on fewer examples
+		 *
+		 * @Returns mean held-out error rate of the best setting
+		 */
+		float CrossValidate(){
+			printf("\nCross Validation (%d folds):\n", this->fold_num);
+			printf("\n%-48s\tMean Error Rate\tStd Dev\n", "Model");
+			size_t best_id = this->slots.size();
+			float best_mean = 0;
+			for (size_t i = 0; i + this->fold_num <= this->slots.size(); i += this->fold_num){
+				if (this->slots[i]->is_active == false){
+					continue;
+				}
+				s_array<float> errors;
+				errors.resize(this->fold_num);
+				for (int k = 0; k < this->fold_num; ++k){
+					errors[k] = this->slots[i + k]->HeldoutErrorRate();
+				}
+				float mean = Average(errors.begin, this->fold_num);
+				//Variance returns the standard deviation, in % like the mean
+				float std_dev = Variance(errors.begin, this->fold_num);
+				const string& name = this->slots[i]->name;
+				printf("%-48s\t%.2f %%\t\t%.2f %%\n", name.substr(0, name.rfind('#')).c_str(),
+					mean * 100, std_dev * 100);
+				if (best_id == this->slots.size() || mean < best_mean){
+					best_id = i;
+					best_mean = mean;
+				}
+			}
+			this->learnModel = this->slots[best_id]->model;
+			printf("\nBest setting: %s\n", this->slots[best_id]->name.c_str());
+			if (this->is_eval == true){
+				//the held-out folds of the best setting cover all the examples
+				eval_metrics heldout_metrics;
+				for (int k = 0; k < this->fold_num; ++k){
+					heldout_metrics.Merge(this->slots[best_id + k]->heldout_metrics);
+				}
+				heldout_metrics.Print("Held-out");
+				this->train_metrics.Reset(this->learnModel->GetClassfierNum());
+				this->train_metrics.Merge(this->slots[best_id]->train_metrics);
+			}
+			return best_mean;
+		}
+
+		/**
+		 * @Synopsis EndChunk called after all the models are trained on a chunk
+		 *
+		 * @Param data_count number of examples processed
+		 */
+		virtual void EndChunk(size_t data_count){}
+
+		/**
+		 * @Synopsis GetBestSlot get the active model with the lowest error rate
+		 */
+		SlotType* GetBestSlot() const {
+			SlotType* best_slot = NULL;
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				SlotType* slot = this->slots[i];
+				if (slot->is_active == true &&
+					(best_slot == NULL || slot->ErrorRate() < best_slot->ErrorRate())){
+					best_slot = slot;
+				}
+			}
+			return best_slot;
+		}
+
+		/**
+		 * @Synopsis PrintSlots print the results of each model
+		 */
+		virtual void PrintSlots() const {
+			printf("\nSettings:\n");
+			printf("\n%-48s\tData Number\tError Rate\tTime (s)", "Model");
+			printf(this->fold_num > 1 ? "\tHeld-out Error Rate\n" : "\n");
+			for (size_t i = 0; i < this->slots.size(); ++i){
+				const SlotType &slot = *this->slots[i];
+				printf("%-48s\t%lu\t\t%.2f %%\t\t%.3f", slot.name.c_str(),
+					slot.dataNum, slot.ErrorRate() * 100, slot.train_time);
+				if (this->fold_num > 1){
+					printf("\t\t%.2f %%\n", slot.HeldoutErrorRate() * 100);
+				}
+				else{
+					printf("\n");
+				}
+			}
+		}
+
+#pragma region Workers
+	protected:
+		void StartWorkers(){
+			this->is_stop = false;
+			this->task_id = 0;
+			this->threads.resize(this->thread_num);
+			this->worker_params.resize(this->thread_num);
+			//the main thread works as the first worker
+			for (int i = 1; i < this->thread_num; ++i){
+				this->worker_params[i].optimizer = this;
+				this->worker_params[i].thread_id = i;
+#if WIN32
+				create_thread(this->threads[i], static_cast<LPTHREAD_START_ROUTINE>(MultiOptimizer<FeatType, LabelType>::WorkerRoutine),
+					&this->worker_params[i]);
+#else
+				create_thread(this->threads[i], MultiOptimizer<FeatType, LabelType>::WorkerRoutine,
+					&this->worker_params[i]);
+#endif
+			}
+		}
+
+		void StopWorkers(){
+			mutex_lock(&this->task_lock);
+			this->is_stop = true;
+			condition_variable_signal_all(&this->task_ready);
+			mutex_unlock(&this->task_lock);
+			for (int i = 1; i < this->thread_num; ++i){
+				join_thread(this->threads[i]);
+			}
+		}
+
+		/**
+		 * @Synopsis DispatchChunk train all the active models on the chunk,
+		 * return after all the workers finish
+		 *
+		 * @Param chunk shared chunk of data
+		 */
+		void DispatchChunk(const DataChunk<PointType> &chunk){
+			mutex_lock(&this->task_lock);
+			this->cur_chunk = &chunk;
+			this->next_slot = 0;
+			this->pending_num = this->thread_num - 1;
+			this->task_id++;
+			condition_variable_signal_all(&this->task_ready);
+			mutex_unlock(&this->task_lock);
+
+			this->TrainSlots(chunk);
+
+			mutex_lock(&this->task_lock);
+			while (this->pending_num > 0){
+				condition_variable_wait(&this->task_done, &this->task_lock);
+			}
+			this->cur_chunk = NULL;
+			mutex_unlock(&this->task_lock);
+		}
+
+		/**
+		 * @Synopsis TrainSlots fetch and train the untrained models on the chunk
+		 */
+		void TrainSlots(const DataChunk<PointType> &chunk){
+			while (1){
+				mutex_lock(&this->task_lock);
+				size_t slot_id = this->next_slot++;
+				mutex_unlock(&this->task_lock);
+				if (slot_id >= this->slots.size()){
+					break;
+				}
+				SlotType &slot = *this->slots[slot_id];
+				if (slot.is_active == false){
+					continue;
+				}
+				if (this->is_testing == true){
+					this->TestSlot(slot, chunk);
+					continue;
+				}
+				double time1 = get_current_time();
+				this->TrainSlot(slot, chunk);
+				slot.train_time += get_current_time() - time1;
+			}
+		}
+
+		void WorkerLoop(){
+			size_t last_task_id = 0;
+			while (1){
+				mutex_lock(&this->task_lock);
+				while (this->task_id == last_task_id && this->is_stop == false){
+					condition_variable_wait(&this->task_ready, &this->task_lock);
+				}
+				if (this->is_stop == true){
+					mutex_unlock(&this->task_lock);
+					break;
+				}
+				last_task_id = this->task_id;
+				const DataChunk<PointType> *chunk = this->cur_chunk;
+				mutex_unlock(&this->task_lock);
+
+				this->TrainSlots(*chunk);
+
+				mutex_lock(&this->task_lock);
+				if (--this->pending_num == 0){
+					condition_variable_signal(&this->task_done);
+				}
+				mutex_unlock(&this->task_lock);
+			}
+		}
+
+#if WIN32
+		static DWORD WINAPI WorkerRoutine(LPVOID param)
+#else
+		static void* WorkerRoutine(void* param)
+#endif
+		{
+			WorkerParam* worker_param = static_cast<WorkerParam*>(param);
+			worker_param->optimizer->WorkerLoop();
+#if WIN32
+			return 0;
+#else
+			return NULL;
+#endif
+		}
+#pragma endregion Workers
+	};
+
+	template <typename FeatType, typename LabelType>
+	ClassInfo MultiOptimizer<FeatType, LabelType>::classInfo("opt_multi",
+		"train models with different settings on the same data in one pass", MultiOptimizer<FeatType, LabelType>::CreateObject);
+
+	template <typename FeatType, typename LabelType>
+	void* MultiOptimizer<FeatType, LabelType>::CreateObject(void* model, void* dataset, void* param3) {
+		return new MultiOptimizer<FeatType, LabelType>((OnlineModel<FeatType, LabelType>*)model,
+			(DataSet<FeatType, LabelType>*)dataset);
+	}
+}
+
+#endif
@@ -9,6 +9,17 @@
 
 #include "Optimizer.h"
 #include "../algorithms/om/OnlineModel.h"
+#include "../algorithms/om/StaticIterator.h"
+#include "../utils/state_io.h"
+
+#include <algorithm>
+#include <sstream>
+
+#if !WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 
 /**
 *  namespace: Batch and Online Classification
@@ -21,7 +32,37 @@ namespace BOC {
 		DECLARE_CLASS
 
 		OnlineModel<FeatType, LabelType> *p_onlineModel;
-		int (OnlineModel<FeatType, LabelType>::*pIterateDelegate)(const DataPoint<FeatType, LabelType> &x, float* predict);
+
+		//number of examples in a mini-batch
+		size_t batch_size;
+
+		//training loop specialized for the model and the loss, NULL if not available
+		OnlineIterator<FeatType, LabelType> *p_iterator;
+
+		//path of the checkpoints, empty if disabled
+		string ckpt_file;
+		//a checkpoint is taken after ckpt_every examples or ckpt_secs seconds
+		size_t ckpt_every;
+		float ckpt_secs;
+		//checkpoint from which the training is resumed
+		string resume_file;
+#if !WIN32
+		//process writing the last checkpoint, 0 if none
+		pid_t ckpt_pid;
+#endif
+
+		//path of the telemetry records, one json object in a line, empty if disabled
+		string metrics_file;
+		FILE* metrics_os;
+		//a record is written after metrics_every examples or metrics_secs seconds
+		size_t metrics_every;
+		float metrics_secs;
+		//bytes read from the input by the processed chunks
+		size_t read_bytes;
+		//number of examples, bytes and time of the last record
+		size_t metrics_times;
+		size_t metrics_bytes;
+		double metrics_time;
 
 	protected:
 		typedef typename Optimizer<FeatType, LabelType>::PointType PointType;
@@ -31,42 +72,101 @@ namespace BOC {
 		 */
 	public:
 		OnlineOptimizer(OnlineModel<FeatType, LabelType> *model, DataSet<FeatType, LabelType> *dataset) :
-			Optimizer<FeatType, LabelType>(model, dataset){
+			Optimizer<FeatType, LabelType>(model, dataset), batch_size(1), p_iterator(NULL),
+			ckpt_every(0), ckpt_secs(0), metrics_os(NULL), metrics_every(0), metrics_secs(0),
+			read_bytes(0), metrics_times(0), metrics_bytes(0), metrics_time(0){
+#if !WIN32
+			this->ckpt_pid = 0;
+#endif
 			p_onlineModel = static_cast<OnlineModel<FeatType, LabelType>*>(this->learnModel);
-			if (this->p_onlineModel->GetClassfierNum() == 1){
-				this->pIterateDelegate = &OnlineModel<FeatType, LabelType>::IterateBC;
-			}
-			else{
-				this->pIterateDelegate = &OnlineModel<FeatType, LabelType>::IterateMC;
+
+			const string& iter_name = OnlineIterator<FeatType, LabelType>::GetIteratorName(this->p_onlineModel);
+			if (Registry::IsRegistered(iter_name) == true){
+				this->p_iterator = (OnlineIterator<FeatType, LabelType>*)
+					Registry::CreateObject(iter_name, this->p_onlineModel);
 			}
 		}
 
 		virtual ~OnlineOptimizer() {
+			this->WaitCheckpoint(true);
+			DELETE_POINTER(this->p_iterator);
 		}
 
 		/**
 		 * @Synopsis inherited functions
 		 */
 	public:
+		/**
+		 * @Synopsis SetParameter set parameters for the optimizer
+		 *
+		 */
+		virtual void SetParameter(BOC::Params &param){
+			Optimizer<FeatType, LabelType>::SetParameter(param);
+			int batch = param.IntValue("-batch");
+			if (batch > 1){
+				if (this->p_onlineModel->IsBatchSupported() == true){
+					this->batch_size = batch;
+				}
+				else{
+					fprintf(stderr, "Warning: mini-batch is not supported by the model, examples are iterated one by one\n");
+				}
+			}
+			if (this->batch_size > 1 || param.BoolValue("-dynamic") == true){
+				DELETE_POINTER(this->p_iterator);
+			}
+
+			this->ckpt_file = param.StringValue("-ckpt");
+			int ckpt_every = param.IntValue("-ckpt_every");
+			INVALID_ARGUMENT_EXCEPTION(ckpt_every, ckpt_every >= 0, "no smaller than 0");
+			this->ckpt_every = ckpt_every;
+			this->ckpt_secs = param.FloatValue("-ckpt_secs");
+			INVALID_ARGUMENT_EXCEPTION(ckpt_secs, this->ckpt_secs >= 0, "no smaller than 0");
+			this->resume_file = param.StringValue("-resume");
+
+			this->metrics_file = param.StringValue("-metrics_out");
+			int metrics_every = param.IntValue("-metrics_every");
+			INVALID_ARGUMENT_EXCEPTION(metrics_every, metrics_every >= 0, "no smaller than 0");
+			this->metrics_every = metrics_every;
+			this->metrics_secs = param.FloatValue("-metrics_secs");
+			INVALID_ARGUMENT_EXCEPTION(metrics_secs, this->metrics_secs >= 0, "no smaller than 0");
+		}
+
 		//train the data
 		virtual float Train() {
 			//reset
 			if (this->Reset() == false)
 				return 1.f;
 			p_onlineModel->BeginTrain();
-			float errorNum(0);
-			size_t show_step = 1; //show information every show_step
-			size_t show_count = 2;
-			size_t data_count = 0;
+			p_onlineModel->UpdateModelDimention(this->DataDim());
+			IterateStat stat;
+			if (this->is_eval == true){
+				this->train_metrics.Reset(this->learnModel->GetClassfierNum());
+				stat.metrics = &this->train_metrics;
+			}
+
+			//examples iterated before the checkpoint are skipped
+			size_t skip_num = 0;
+			if (this->resume_file.length() > 0){
+				if (this->Resume(stat) == false){
+					return 1.f;
+				}
+				skip_num = this->update_times;
+			}
+			size_t ckpt_times = this->update_times;
+			double ckpt_time = get_current_time();
+			this->BeginMetrics();
 
 			//double train_time  = 0;
 			printf("\nIterations:\n");
 			printf("\nIterate No.\t\tError Rate\t\t\n");
 
-			int classNum = this->learnModel->GetClassfierNum();
-			float* predictVal = new float[classNum];
-			int predictLabel = 0;
+			if (this->p_iterator != NULL){
+				printf("Specialized training loop: %s\n", this->p_iterator->GetType().c_str());
+			}
 
+			int classNum = this->learnModel->GetClassfierNum();
+			float* predictVal = new float[classNum * this->batch_size];
+			int* predictLabels = new int[this->batch_size];
 
 			while (1) {
 				DataChunk<PointType> &chunk = this->dataSet->GetChunk();
@@ -77,44 +177,255 @@ namespace BOC {
 					break;
 				}
 
-				for (size_t i = 0; i < chunk.dataNum; i++) {
-					PointType &data = chunk.data[i];
-					this->FilterFeatures(data);
-
-					p_onlineModel->UpdateModelDimention(data.dim());
-					//int predictLabel = p_onlineModel->Iterate(data, predictVal);
-					int predictLabel = this->IterateDelegate(data, predictVal);
-					//loss
-					if (predictLabel != data.label){
-						errorNum++;
-						if (classNum == 1){
-							data.margin = *predictVal * data.label;
-						}
-						else{
-							data.margin = predictVal[predictLabel];
-						}
+				//the chunk is iterated from start_id, the chunks are not changed as
+				//they may be read again in the next passes
+				size_t start_id = 0;
+				if (skip_num > 0){
+					if (chunk.dataNum <= skip_num){
+						skip_num -= chunk.dataNum;
+						this->dataSet->FinishRead();
+						continue;
 					}
+					//the checkpoint was taken in the middle of the chunk
+					start_id = skip_num;
+					skip_num = 0;
+				}
 
-					data_count++;
-					this->update_times++;
-					if (show_count == data_count){
-						printf("%lu\t\t\t%.6f\n", data_count, errorNum / (float)(data_count));
-						show_count = (size_t(1) << ++show_step);
+				//pre-selected features
+				if (this->max_index > 0){
+					for (size_t i = 0; i < chunk.dataNum; ++i){
+						this->FilterFeatures(chunk.data[i]);
 					}
 				}
+
+				if (start_id > 0 && this->batch_size == 1){
+					//the rest of the chunk the checkpoint was taken in
+					p_onlineModel->UpdateModelDimention(chunk.max_index);
+					for (size_t i = start_id; i < chunk.dataNum; ++i){
+						PointType &data = chunk.data[i];
+						int predictLabel = classNum == 1 ? p_onlineModel->IterateBC(data, predictVal) :
+							p_onlineModel->IterateMC(data, predictVal);
+						stat.Add(data, predictVal, predictLabel, classNum);
+					}
+				}
+				else if (this->p_iterator != NULL){
+					this->p_iterator->IterateChunk(chunk, predictVal, stat);
+				}
+				else if (this->batch_size == 1){
+					p_onlineModel->IterateChunk(chunk, predictVal, stat);
+				}
+				else{
+					p_onlineModel->UpdateModelDimention(chunk.max_index);
+					size_t batchNum = 1;
+					for (size_t i = start_id; i < chunk.dataNum; i += batchNum) {
+						//mini-batches do not cross chunks
+						batchNum = std::min(this->batch_size, chunk.dataNum - i);
+						p_onlineModel->IterateBatch(&chunk.data[i], batchNum, predictVal, predictLabels);
+						for (size_t j = 0; j < batchNum; ++j){
+							stat.Add(chunk.data[i + j], predictVal + j * classNum, predictLabels[j], classNum);
+						}
+					}
+				}
+				this->update_times += chunk.dataNum - start_id;
+				this->read_bytes += chunk.read_bytes;
+
+				for (size_t i = 0; i < stat.progress.size(); ++i){
+					this->PrintProgress(stat.progress[i].first,
+						stat.progress[i].second / (float)(stat.progress[i].first));
+				}
+				stat.progress.clear();
 				//double time2 = get_current_time();
 				//train_time += time2 - time1;
 				this->dataSet->FinishRead();
+
+				if (this->ckpt_file.length() > 0 &&
+					((this->ckpt_every > 0 && this->update_times - ckpt_times >= this->ckpt_every) ||
+					(this->ckpt_secs > 0 && get_current_time() - ckpt_time >= this->ckpt_secs))){
+					if (this->SaveCheckpoint(stat) == true){
+						ckpt_times = this->update_times;
+						ckpt_time = get_current_time();
+					}
+				}
+				if (this->metrics_os != NULL &&
+					((this->metrics_every > 0 && this->update_times - this->metrics_times >= this->metrics_every) ||
+					(this->metrics_secs > 0 && get_current_time() - this->metrics_time >= this->metrics_secs))){
+					this->WriteMetrics(stat);
+				}
 			}
+			this->WaitCheckpoint(true);
 			p_onlineModel->EndTrain();
+			if (this->metrics_os != NULL){
+				//the last record is of the end of training
+				if (this->update_times != this->metrics_times){
+					this->WriteMetrics(stat);
+				}
+				fclose(this->metrics_os);
+				this->metrics_os = NULL;
+			}
 
 			delete[]predictVal;
+			delete[]predictLabels;
 			//cout<<"Purely Training Time: "<<train_time<<" s"<<endl;
-			return errorNum / this->update_times;
+			return stat.errorNum / (float)this->update_times;
+		}
+
+	protected:
+		/**
+		 * @Synopsis BeginMetrics open the file of the telemetry records
+		 */
+		void BeginMetrics() {
+			this->read_bytes = 0;
+			this->metrics_times = this->update_times;
+			this->metrics_bytes = 0;
+			this->metrics_time = get_current_time();
+			if (this->metrics_file.length() == 0){
+				return;
+			}
+			this->metrics_os = fopen(this->metrics_file.c_str(), "w");
+			if (this->metrics_os == NULL){
+				fprintf(stderr, "Error: open metrics file %s failed!\n", this->metrics_file.c_str());
+			}
+		}
+
+		/**
+		 * @Synopsis WriteMetrics write a telemetry record of the progress, the
+		 * rates are of the examples since the last record. The file is
+		 * flushed so that the record can be read during training.
+		 *
+		 * @Param stat training statistics
+		 */
+		void WriteMetrics(const IterateStat &stat) {
+			double cur_time = get_current_time();
+			double elapsed = cur_time - this->metrics_time;
+			double example_rate = elapsed > 0 ? (this->update_times - this->metrics_times) / elapsed : 0;
+			double byte_rate = elapsed > 0 ? (this->read_bytes - this->metrics_bytes) / elapsed : 0;
+			fprintf(this->metrics_os, "{\"time\": %.3f, \"examples\": %lu, \"examples_per_sec\": %.1f, "
+				"\"bytes\": %lu, \"bytes_per_sec\": %.1f, \"errors\": %lu, \"error_rate\": %.6f, ",
+				cur_time - this->start_time, this->update_times, example_rate, this->read_bytes, byte_rate,
+				stat.errorNum, stat.dataNum == 0 ? 0 : stat.errorNum / (double)stat.dataNum);
+			fprintf(this->metrics_os, "\"eta\": %g, \"nonzero_weights\": %lu, ",
+				this->p_onlineModel->GetLearningRate(), (size_t)this->p_onlineModel->GetNonZeroNum());
+			float occupancy = this->dataSet->GetBufferOccupancy();
+			if (occupancy >= 0){
+				fprintf(this->metrics_os, "\"buffer_occupancy\": %.3f, ", occupancy);
+			}
+			else{
+				fprintf(this->metrics_os, "\"buffer_occupancy\": null, ");
+			}
+			fprintf(this->metrics_os, "\"rss_bytes\": %lu", get_rss_bytes());
+			PipelineStats pipeline_stats;
+			if (this->dataSet->GetPipelineStats(pipeline_stats) == true){
+				fprintf(this->metrics_os, ", \"pipeline\": {\"load_secs\": %.3f, \"cache_secs\": %.3f, "
+					"\"process_secs\": %.3f, \"loader_wait_secs\": %.3f, \"loader_waits\": %lu, "
+					"\"learner_wait_secs\": %.3f, \"learner_waits\": %lu, \"chunks\": %lu, "
+					"\"chunk_fill\": %.4f, \"parsed_chunks\": %.3f}",
+					pipeline_stats.load_time, pipeline_stats.cache_time, pipeline_stats.process_time,
+					pipeline_stats.write_wait_time, pipeline_stats.write_wait_num,
+					pipeline_stats.read_wait_time, pipeline_stats.read_wait_num, pipeline_stats.chunk_num,
+					pipeline_stats.FillRate(), pipeline_stats.AverageParsed());
+			}
+			fprintf(this->metrics_os, "}\n");
+			fflush(this->metrics_os);
+
+			this->metrics_times = this->update_times;
+			this->metrics_bytes = this->read_bytes;
+			this->metrics_time = cur_time;
 		}
 
-		inline int IterateDelegate(const DataPoint<FeatType, LabelType> &x, float* predict){
-			return (this->p_onlineModel->*pIterateDelegate)(x, predict);
+		/**
+		 * @Synopsis SaveCheckpoint save the model, the state of the
+		 * optimization and the number of iterated examples. The checkpoint is
+		 * written by a child process from a copy-on-write snapshot of the
+		 * memory, so that training is not paused.
+		 *
+		 * @Param stat training statistics
+		 *
+		 * @Returns false if the last checkpoint is still being written
+		 */
+		bool SaveCheckpoint(const IterateStat &stat) {
+			std::ostringstream progress;
+			write_value(progress, (uint64_t)this->update_times);
+			write_value(progress, (uint64_t)stat.errorNum);
+			write_value(progress, (uint64_t)stat.dataNum);
+			write_value(progress, (uint64_t)stat.show_count);
+			write_value(progress, stat.show_step);
+#if WIN32
+			this->p_onlineModel->SaveCheckpoint(this->ckpt_file, progress.str());
+#else
+			if (this->WaitCheckpoint(false) == false){
+				return false;
+			}
+			pid_t pid = fork();
+			if (pid == 0){
+				bool ret = this->p_onlineModel->SaveCheckpoint(this->ckpt_file, progress.str());
+				_exit(ret == true ? 0 : 1);
+			}
+			else if (pid < 0){
+				//write in place if the process can not be created
+				this->p_onlineModel->SaveCheckpoint(this->ckpt_file, progress.str());
+			}
+			this->ckpt_pid = pid > 0 ? pid : 0;
+#endif
+			return true;
+		}
+
+		/**
+		 * @Synopsis WaitCheckpoint wait for the process writing the last
+		 * checkpoint
+		 *
+		 * @Param is_block whether to wait until the checkpoint is written
+		 *
+		 * @Returns false if the checkpoint is still being written
+		 */
+		bool WaitCheckpoint(bool is_block) {
+#if !WIN32
+			if (this->ckpt_pid == 0){
+				return true;
+			}
+			int status = 0;
+			pid_t ret = waitpid(this->ckpt_pid, &status, is_block == true ? 0 : WNOHANG);
+			if (ret == 0){
+				return false;
+			}
+			if (ret < 0 || WIFEXITED(status) == false || WEXITSTATUS(status) != 0){
+				fprintf(stderr, "write checkpoint %s failed!\n", this->ckpt_file.c_str());
+			}
+			this->ckpt_pid = 0;
+#endif
+			return true;
+		}
+
+		/**
+		 * @Synopsis Resume load the checkpoint and the number of iterated
+		 * examples, called after the model begins training
+		 *
+		 * @Param stat training statistics
+		 *
+		 * @Returns true if load successfully
+		 */
+		bool Resume(IterateStat &stat) {
+			string progress;
+			if (this->p_onlineModel->LoadCheckpoint(this->resume_file, progress) == false){
+				fprintf(stderr, "load checkpoint %s failed!\n", this->resume_file.c_str());
+				return false;
+			}
+			state_reader reader(progress.data(), progress.size());
+			uint64_t update_times = 0, errorNum = 0, dataNum = 0, show_count = 0;
+			reader.read_value(update_times);
+			reader.read_value(errorNum);
+			reader.read_value(dataNum);
+			reader.read_value(show_count);
+			reader.read_value(stat.show_step);
+			if (reader.ok() == false){
+				fprintf(stderr, "incorrect checkpoint %s!\n", this->resume_file.c_str());
+				return false;
+			}
+			this->update_times = (size_t)update_times;
+			stat.errorNum = (size_t)errorNum;
+			stat.dataNum = (size_t)dataNum;
+			stat.show_count = (size_t)show_count;
+			printf("Resume from %lu iterated examples\n", this->update_times);
+			return true;
 		}
 	};
 
@@ -12,6 +12,8 @@
 #include "../algorithms/LearnModel.h"
 
 #include "../utils/reflector.h"
+#include "../utils/util.h"
+#include "../utils/eval_metrics.h"
 
 
 #include <fstream>
@@ -39,6 +41,16 @@ namespace BOC{
 		s_array<char> sel_feat_flag_vec;
 		IndexType max_index;
 
+		//expected number of iterations for the ETA, 0 if unknown
+		size_t total_times;
+		double start_time;
+
+		//whether AUC, log loss and the other metrics are computed
+		bool is_eval;
+		//metrics of the predictions before the updates in training
+		eval_metrics train_metrics;
+		eval_metrics test_metrics;
+
 
 		/**
 		 * @Synopsis Constructors
@@ -48,6 +60,9 @@ namespace BOC{
 			learnModel(model), dataSet(dataset) {
 			this->update_times = 0;
 			this->max_index = 0;
+			this->total_times = 0;
+			this->start_time = 0;
+			this->is_eval = false;
 		}
 
 		virtual ~Optimizer() {
@@ -60,6 +75,14 @@ namespace BOC{
 		//train the data
 		virtual float Train() = 0;
 
+		/**
+		 * @Synopsis SetParameter set parameters for the optimizer
+		 *
+		 */
+		virtual void SetParameter(BOC::Params &param){
+			this->is_eval = param.BoolValue("-eval");
+		}
+
 		/**
 		 * @Synopsis Test test the performance on the given set
 		 *
@@ -67,12 +90,16 @@ namespace BOC{
 		 *
 		 * @Returns
 		 */
-		float Test(DataSet<FeatType, LabelType> &testSet) {
+		virtual float Test(DataSet<FeatType, LabelType> &testSet) {
 			testSet.Rewind();
 			float errorRate(0);
 			//double test_time = 0;
 			//test
+			this->learnModel->Freeze();
 			float* predicts = new float[this->learnModel->GetClassfierNum()];
+			if (this->is_eval == true){
+				this->test_metrics.Reset(this->learnModel->GetClassfierNum());
+			}
 			while (1) {
 				const DataChunk<PointType> &chunk = testSet.GetChunk();
 				//double time1 = get_current_time();
@@ -82,6 +109,9 @@ namespace BOC{
 					const PointType &data = chunk.data[i];
 					//predict
 					int predict = this->learnModel->Predict(data, predicts);
+					if (this->is_eval == true){
+						this->test_metrics.Add(data.label, predicts, predict);
+					}
 					if (predict != data.label)
 						errorRate++;
 				}
@@ -102,12 +132,16 @@ namespace BOC{
 		 *
 		 * @Returns
 		 */
-		float Test(DataSet<FeatType, LabelType> &testSet, std::ostream& os) {
+		virtual float Test(DataSet<FeatType, LabelType> &testSet, std::ostream& os) {
 			testSet.Rewind();
 			float errorRate(0);
 			//double test_time = 0;
 			//test
+			this->learnModel->Freeze();
 			float* predicts = new float[this->learnModel->GetClassfierNum()];
+			if (this->is_eval == true){
+				this->test_metrics.Reset(this->learnModel->GetClassfierNum());
+			}
 			while (1) {
 				const DataChunk<PointType> &chunk = testSet.GetChunk();
 				//double time1 = get_current_time();
@@ -117,6 +151,9 @@ namespace BOC{
 					const PointType &data = chunk.data[i];
 					//predict
 					int predict = this->learnModel->Predict(data, predicts);
+					if (this->is_eval == true){
+						this->test_metrics.Add(data.label, predicts, predict);
+					}
 					os << predict << "\t" << (int)(data.label) << "\n";
 					if (predict != data.label){
 						errorRate++;
@@ -138,6 +175,36 @@ namespace BOC{
 		 */
 		inline size_t GetUpdateTimes() const { return this->update_times; }
 
+		/**
+		 * @Synopsis GetModel get the trained model
+		 *
+		 * @Returns the learned model, the best one if multiple models are trained
+		 */
+		inline LearnModel<FeatType, LabelType>* GetModel() const { return this->learnModel; }
+
+		/**
+		 * @Synopsis GetTrainMetrics get the metrics of the predictions in
+		 * training, empty if not evaluated
+		 */
+		inline const eval_metrics& GetTrainMetrics() const { return this->train_metrics; }
+
+		/**
+		 * @Synopsis GetTestMetrics get the metrics of the last test, empty if
+		 * not evaluated
+		 */
+		inline const eval_metrics& GetTestMetrics() const { return this->test_metrics; }
+
+		/**
+		 * @Synopsis SaveModel save the trained model to disk
+		 *
+		 * @Param filename  name to the saved file
+		 *
+		 * @Returns true if saved successfully
+		 */
+		virtual bool SaveModel(const string& filename){
+			return this->learnModel->SaveModel(filename);
+		}
+
 	protected:
 		/**
 		 * @Synopsis Reset reset the optimizer
@@ -146,10 +213,42 @@ namespace BOC{
 		 */
 		bool Reset() {
 			this->update_times = 0;
+			const DataStats* stats = this->dataSet->GetStats();
+			this->total_times = stats == NULL ? 0 :
+				(size_t)stats->data_num * this->dataSet->GetPassNum();
+			this->start_time = get_current_time();
 			this->dataSet->Rewind();
 			return true;
 		}
 
+		/**
+		 * @Synopsis DataDim dimension of the data known before training, so
+		 * that the models are allocated once instead of growing with the data
+		 *
+		 * @Returns 0 if not known
+		 */
+		IndexType DataDim() const {
+			const DataStats* stats = this->dataSet->GetStats();
+			//the mapped indexes are not known in advance
+			if (stats == NULL || this->dataSet->GetFeatureMap().enabled() == true){
+				return 0;
+			}
+			return (IndexType)stats->max_index;
+		}
+
+		/**
+		 * @Synopsis PrintProgress print the error rate after data_count
+		 * iterations, and the estimated remaining time if the data size is known
+		 */
+		void PrintProgress(size_t data_count, float err_rate) const {
+			printf("%lu\t\t\t%.6f", data_count, err_rate);
+			if (this->total_times > data_count && data_count > 0){
+				double elapsed = get_current_time() - this->start_time;
+				printf("\t\tETA %.1f s", elapsed * (this->total_times - data_count) / data_count);
+			}
+			printf("\n");
+		}
+
 	public:
 		/**
 		 * @Synopsis load the feature selection result
@@ -0,0 +1,673 @@
+/*************************************************************************
+	> File Name: PredictServer.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 9:42:15 AM
+	> Functions: serve the predictions of a loaded model to stdin or the
+	> clients of a unix domain socket
+	************************************************************************/
+#ifndef HEADER_PREDICT_SERVER
+#define HEADER_PREDICT_SERVER
+
+#include "../algorithms/LearnModel.h"
+#include "../io/DataPoint.h"
+#include "../io/parser.h"
+#include "../utils/feature_map.h"
+#include "../utils/sparse_kernel.h"
+#include "../utils/thread_primitive.h"
+#include "../utils/util.h"
+#include "../utils/error.h"
+#include "../utils/init_param.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+
+#if !WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace BOC {
+	//whether SIGINT or SIGTERM is received
+	inline volatile sig_atomic_t& predict_server_stopped() {
+		static volatile sig_atomic_t is_stopped = 0;
+		return is_stopped;
+	}
+
+	inline void predict_server_stop(int sig) {
+		predict_server_stopped() = 1;
+	}
+
+	/**
+	 * The examples are read line by line in the libsvm format, the label is
+	 * optional. For each example, a line of the predicted label and the
+	 * scores of the classifiers, separated by tabs, is written back in order.
+	 * Lines that can not be parsed are answered with "error".
+	 *
+	 * The examples of all the clients are scored together in micro-batches.
+	 * A batch is scored once it is full, once no more input is ready, or when
+	 * the first example has waited max_wait milliseconds. The batch is split
+	 * among the threads, which also parse the lines. The client sockets are
+	 * non-blocking, the predictions a client does not read yet are buffered
+	 * and its input is not read until the buffer drains, so a slow client
+	 * does not hold up the others. Latency is the time from reading an
+	 * example to writing or buffering its prediction.
+	 */
+	template <typename FeatType, typename LabelType>
+	class PredictServer {
+	protected:
+		typedef DataPoint<FeatType, LabelType> PointType;
+
+		struct WorkerParam {
+			PredictServer<FeatType, LabelType> *server;
+			int thread_id;
+		};
+
+		//a client, stdin and stdout are served as one
+		struct Connection {
+			int in_fd;
+			int out_fd;
+			//incomplete line
+			string pending;
+			//predictions not written yet, starting from out_pos
+			string out;
+			size_t out_pos;
+			//the input ends
+			bool is_eof;
+			//the output failed
+			bool is_closed;
+		};
+
+		//bytes of predictions buffered for a client before its input is paused
+		static const size_t max_pending_out = 1 << 20;
+
+		LearnModel<FeatType, LabelType> *model;
+		//map of the feature indexes to the weight slots, NULL if not mapped
+		const feature_map *feat_map;
+		int classfier_num;
+		bool is_norm;
+		//number of threads, including the main thread
+		int thread_num;
+		//number of threads scoring the current batch
+		int active_num;
+		//maximum number of examples in a batch
+		size_t max_batch;
+		//milliseconds the first example of a batch waits for more input
+		int max_wait;
+
+		//lines of the current batch, the connection and the time they are read
+		vector<string> lines;
+		vector<size_t> line_conns;
+		vector<double> line_times;
+		size_t batch_num;
+		//predictions of the batch
+		vector<string> results;
+		//buffers of the main thread
+		PointType main_pt;
+		vector<float> main_predicts;
+
+		vector<Connection> conns;
+
+		//workers
+		vector<THREAD> threads;
+		vector<WorkerParam> worker_params;
+		MUTEX task_lock;
+		CV task_ready;
+		CV task_done;
+		//id of the current batch, workers start when it changes
+		size_t task_id;
+		//number of workers that are still scoring the batch
+		int pending_num;
+		bool is_stop;
+
+		//latencies of the served examples in milliseconds
+		vector<float> latencies;
+		double start_time;
+
+	public:
+		PredictServer(LearnModel<FeatType, LabelType> *model) : model(model), feat_map(NULL),
+			is_norm(false), thread_num(1), active_num(1), max_batch(init_serve_batch), max_wait(init_serve_wait),
+			batch_num(0), task_id(0), pending_num(0), is_stop(false), start_time(0) {
+			this->classfier_num = model->GetClassfierNum();
+			initialize_mutex(&this->task_lock);
+			initialize_condition_variable(&this->task_ready);
+			initialize_condition_variable(&this->task_done);
+		}
+
+		~PredictServer() {
+			delete_mutex(&this->task_lock);
+		}
+
+		/**
+		 * @Synopsis SetParameter set the parameters of the server
+		 *
+		 * @Param thread_num number of threads, 0 for the number of processors
+		 * @Param max_batch maximum number of examples in a batch
+		 * @Param max_wait milliseconds the first example of a batch waits
+		 * @Param is_norm whether to normalize the examples
+		 */
+		void SetParameter(int thread_num, int max_batch, int max_wait, bool is_norm) {
+			INVALID_ARGUMENT_EXCEPTION(max_batch, max_batch > 0, "larger than 0");
+			INVALID_ARGUMENT_EXCEPTION(max_wait, max_wait >= 0, "no smaller than 0");
+			this->thread_num = thread_num > 0 ? thread_num : get_cpu_num();
+			this->max_batch = max_batch;
+			this->max_wait = max_wait;
+			this->is_norm = is_norm;
+		}
+
+		/**
+		 * @Synopsis SetFeatureMap map the features of the examples with the
+		 * map the model is loaded with, the map is not changed
+		 */
+		void SetFeatureMap(const feature_map *map) {
+			this->feat_map = map;
+		}
+
+		/**
+		 * @Synopsis Serve serve until the input ends or the process is stopped
+		 *
+		 * @Param address "stdin", or the path of a unix domain socket
+		 *
+		 * @Returns status code
+		 */
+		int Serve(const string &address) {
+#if WIN32
+			fprintf(stderr, "Error %d: serving is not supported on windows\n", STATUS_INVALID_ARGUMENT);
+			return STATUS_INVALID_ARGUMENT;
+#else
+			int listen_fd = -1;
+			if (address == "stdin"){
+				this->AddConnection(0, 1);
+			}
+			else{
+				listen_fd = this->Listen(address);
+				if (listen_fd < 0){
+					return STATUS_IO_ERROR;
+				}
+				//a client closing its socket should not kill the server
+				signal(SIGPIPE, SIG_IGN);
+				fprintf(stderr, "Serving on %s\n", address.c_str());
+			}
+			signal(SIGINT, predict_server_stop);
+			signal(SIGTERM, predict_server_stop);
+
+			this->lines.resize(this->max_batch);
+			this->line_conns.resize(this->max_batch);
+			this->line_times.resize(this->max_batch);
+			this->results.resize(this->max_batch);
+			this->start_time = get_current_time();
+			this->StartWorkers();
+
+			int ret = this->EventLoop(listen_fd);
+
+			this->StopWorkers();
+			if (listen_fd >= 0){
+				close(listen_fd);
+				unlink(address.c_str());
+			}
+			this->PrintLatency();
+			return ret;
+#endif
+		}
+
+#if !WIN32
+	protected:
+		int Listen(const string &path) {
+			struct sockaddr_un addr;
+			if (path.length() >= sizeof(addr.sun_path)){
+				fprintf(stderr, "Error %d: socket path %s is too long\n", STATUS_INVALID_ARGUMENT, path.c_str());
+				return -1;
+			}
+			int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd < 0){
+				fprintf(stderr, "Error %d: create socket failed\n", STATUS_IO_ERROR);
+				return -1;
+			}
+			std::memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			std::strcpy(addr.sun_path, path.c_str());
+			unlink(path.c_str());
+			if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0){
+				fprintf(stderr, "Error %d: listen on %s failed\n", STATUS_IO_ERROR, path.c_str());
+				close(fd);
+				return -1;
+			}
+			return fd;
+		}
+
+		void AddConnection(int in_fd, int out_fd) {
+			Connection conn;
+			conn.in_fd = in_fd;
+			conn.out_fd = out_fd;
+			conn.out_pos = 0;
+			conn.is_eof = false;
+			conn.is_closed = false;
+			this->conns.push_back(conn);
+		}
+
+		/**
+		 * @Synopsis EventLoop read the input of all the connections, write
+		 * the buffered predictions, and score the batches
+		 *
+		 * @Param listen_fd the listening socket, -1 to serve stdin
+		 */
+		int EventLoop(int listen_fd) {
+			vector<struct pollfd> fds;
+			//position of the input and output of each connection in fds, -1 if not polled
+			vector<int> in_ids;
+			vector<int> out_ids;
+			char buf[65536];
+			while (predict_server_stopped() == 0){
+				//there is no more input from stdin
+				if (listen_fd < 0 && this->conns.empty() == true){
+					break;
+				}
+
+				size_t conn_num = this->conns.size();
+				fds.clear();
+				in_ids.assign(conn_num, -1);
+				out_ids.assign(conn_num, -1);
+				for (size_t i = 0; i < conn_num; ++i){
+					Connection &conn = this->conns[i];
+					if (conn.is_closed == true){
+						continue;
+					}
+					//the input of a client not reading its predictions is paused
+					if (conn.is_eof == false && conn.out.size() - conn.out_pos < max_pending_out){
+						struct pollfd pfd = { conn.in_fd, POLLIN, 0 };
+						in_ids[i] = (int)fds.size();
+						fds.push_back(pfd);
+					}
+					if (conn.out_pos < conn.out.size()){
+						if (in_ids[i] >= 0 && conn.in_fd == conn.out_fd){
+							fds[in_ids[i]].events |= POLLOUT;
+							out_ids[i] = in_ids[i];
+						}
+						else{
+							struct pollfd pfd = { conn.out_fd, POLLOUT, 0 };
+							out_ids[i] = (int)fds.size();
+							fds.push_back(pfd);
+						}
+					}
+				}
+				if (listen_fd >= 0){
+					struct pollfd pfd = { listen_fd, POLLIN, 0 };
+					fds.push_back(pfd);
+				}
+
+				//with a batch waiting, only check whether more input is ready
+				int timeout = this->batch_num > 0 ? 0 : -1;
+				int ready_num = poll(fds.empty() == true ? NULL : &fds[0], fds.size(), timeout);
+				if (ready_num < 0){
+					if (errno == EINTR){
+						continue;
+					}
+					fprintf(stderr, "Error %d: poll failed\n", STATUS_IO_ERROR);
+					return STATUS_IO_ERROR;
+				}
+
+				bool is_input = false;
+				for (size_t i = 0; i < conn_num && ready_num > 0; ++i){
+					Connection &conn = this->conns[i];
+					if (out_ids[i] >= 0 && fds[out_ids[i]].revents != 0){
+						this->Flush(conn);
+					}
+					if (in_ids[i] < 0 || (fds[in_ids[i]].revents & (POLLIN | POLLHUP | POLLERR)) == 0){
+						continue;
+					}
+					ssize_t len = read(conn.in_fd, buf, sizeof(buf));
+					if (len < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)){
+						continue;
+					}
+					is_input = true;
+					if (len <= 0){
+						//the last line may have no line break
+						if (conn.pending.empty() == false){
+							this->AddLine(i, conn.pending);
+							conn.pending.clear();
+						}
+						conn.is_eof = true;
+						continue;
+					}
+					this->ReadLines(i, buf, len);
+				}
+				if (listen_fd >= 0 && (fds.back().revents & POLLIN) != 0){
+					int fd = accept(listen_fd, NULL, NULL);
+					if (fd >= 0){
+						fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+						this->AddConnection(fd, fd);
+						is_input = true;
+					}
+				}
+
+				//score if the input is drained or the first example waits too long
+				if (this->batch_num > 0 && (is_input == false ||
+					get_current_time() >= this->line_times[0] + this->max_wait / 1000.0)){
+					this->ScoreBatch();
+				}
+				//the batch refers to the connections by position
+				if (this->batch_num == 0){
+					this->RemoveClosed(listen_fd >= 0);
+				}
+			}
+			this->ScoreBatch();
+			for (size_t i = 0; i < this->conns.size(); ++i){
+				this->Flush(this->conns[i]);
+			}
+			return STATUS_OK;
+		}
+
+		//split the input into lines, a batch is scored once it is full
+		void ReadLines(size_t conn_id, const char* buf, ssize_t len) {
+			Connection &conn = this->conns[conn_id];
+			const char* p = buf;
+			const char* p_end = buf + len;
+			while (p < p_end){
+				const char* line_end = (const char*)std::memchr(p, '\n', p_end - p);
+				if (line_end == NULL){
+					conn.pending.append(p, p_end);
+					break;
+				}
+				if (conn.pending.empty() == true){
+					this->AddLine(conn_id, p, line_end);
+				}
+				else{
+					conn.pending.append(p, line_end);
+					this->AddLine(conn_id, conn.pending);
+					conn.pending.clear();
+				}
+				p = line_end + 1;
+			}
+		}
+
+		inline void AddLine(size_t conn_id, const string &line) {
+			this->AddLine(conn_id, line.data(), line.data() + line.size());
+		}
+
+		void AddLine(size_t conn_id, const char* p, const char* p_end) {
+			//empty lines are not answered
+			const char* q = p;
+			while (q < p_end && is_space(const_cast<char*>(q)) == true){
+				++q;
+			}
+			if (q == p_end){
+				return;
+			}
+			this->lines[this->batch_num].assign(p, p_end);
+			this->line_conns[this->batch_num] = conn_id;
+			this->line_times[this->batch_num] = get_current_time();
+			if (++this->batch_num == this->max_batch){
+				this->ScoreBatch();
+			}
+		}
+
+		void RemoveClosed(bool is_socket) {
+			size_t j = 0;
+			for (size_t i = 0; i < this->conns.size(); ++i){
+				const Connection &conn = this->conns[i];
+				//a finished client is removed once its predictions are written
+				if (conn.is_closed == true || (conn.is_eof == true && conn.out_pos == conn.out.size())){
+					if (is_socket == true){
+						close(this->conns[i].in_fd);
+					}
+					continue;
+				}
+				this->conns[j++] = this->conns[i];
+			}
+			this->conns.resize(j);
+		}
+
+		//score the batch and write the predictions back to the clients
+		void ScoreBatch() {
+			if (this->batch_num == 0){
+				return;
+			}
+			this->DispatchBatch();
+
+			for (size_t k = 0; k < this->batch_num; ++k){
+				this->conns[this->line_conns[k]].out += this->results[k];
+			}
+			for (size_t i = 0; i < this->conns.size(); ++i){
+				this->Flush(this->conns[i]);
+			}
+			double now = get_current_time();
+			for (size_t k = 0; k < this->batch_num; ++k){
+				this->latencies.push_back((float)((now - this->line_times[k]) * 1000));
+			}
+			this->batch_num = 0;
+		}
+
+		//write the buffered predictions until the client would block
+		void Flush(Connection &conn) {
+			while (conn.is_closed == false && conn.out_pos < conn.out.size()){
+				ssize_t len = write(conn.out_fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos);
+				if (len < 0){
+					if (errno == EINTR){
+						continue;
+					}
+					if (errno != EAGAIN && errno != EWOULDBLOCK){
+						conn.is_closed = true;
+					}
+					break;
+				}
+				conn.out_pos += len;
+			}
+			if (conn.is_closed == true || conn.out_pos == conn.out.size()){
+				conn.out.clear();
+				conn.out_pos = 0;
+			}
+			else if (conn.out_pos > conn.out.size() / 2){
+				conn.out.erase(0, conn.out_pos);
+				conn.out_pos = 0;
+			}
+		}
+#endif
+
+	protected:
+		/**
+		 * @Synopsis ScoreLines parse and score the thread_id-th part of the
+		 * batch
+		 */
+		void ScoreLines(int thread_id, PointType &pt, vector<float> &predicts) {
+			size_t begin = this->batch_num * thread_id / this->active_num;
+			size_t end = this->batch_num * (thread_id + 1) / this->active_num;
+			bool is_mapped = this->feat_map != NULL && this->feat_map->enabled();
+			char buf[32];
+			for (size_t k = begin; k < end; ++k){
+				string &result = this->results[k];
+				result.clear();
+				if (this->ParseLine(this->lines[k], pt) == false){
+					result = "error\n";
+					continue;
+				}
+				if (is_mapped == true){
+					this->feat_map->lookup_point(pt);
+				}
+				pt.is_strict = sparse_is_strict(pt.indexes.begin, pt.indexes.size());
+				if (this->is_norm == true){
+					pt.Normalize();
+				}
+				int predict = this->model->Predict(pt, &predicts[0]);
+				snprintf(buf, sizeof(buf), "%d", predict);
+				result += buf;
+				for (int c = 0; c < this->classfier_num; ++c){
+					snprintf(buf, sizeof(buf), "\t%g", predicts[c]);
+					result += buf;
+				}
+				result += '\n';
+			}
+		}
+
+		/**
+		 * @Synopsis ParseLine parse an example in the libsvm format, the
+		 * label is optional
+		 *
+		 * @Returns false if the line is invalid
+		 */
+		bool ParseLine(string &line, PointType &pt) {
+			pt.erase();
+			char* p = strip_line(&line[0]);
+			char* endptr = NULL;
+			//the first token is a label if it has no colon
+			char* q = p;
+			while (*q != '\0' && *q != ':' && is_space(q) == false){
+				++q;
+			}
+			if (*q != ':'){
+				parseInt(p, &endptr);
+				if (endptr == p){
+					return false;
+				}
+			}
+			else{
+				endptr = p;
+			}
+			//binary classifiers predict 1 or -1
+			pt.label = this->classfier_num == 1 ? 1 : 0;
+			while (1){
+				p = strip_line(endptr);
+				if (*p == '\0')
+					break;
+				IndexType index = (IndexType)(parseUint(p, &endptr));
+				if (endptr == p){
+					return false;
+				}
+				p = strip_line(endptr);
+				if (*p != ':'){
+					return false;
+				}
+				++p;
+				FeatType feat = parseFloat(p, &endptr);
+				if (endptr == p){
+					return false;
+				}
+				pt.AddNewFeat(index, feat);
+			}
+			return true;
+		}
+
+		void PrintLatency() {
+			size_t num = this->latencies.size();
+			double elapsed = get_current_time() - this->start_time;
+			fprintf(stderr, "Served examples: %lu (%.0f per second)\n", (unsigned long)num,
+				elapsed > 0 ? num / elapsed : 0.0);
+			if (num == 0){
+				return;
+			}
+			vector<float> &lat = this->latencies;
+			std::nth_element(lat.begin(), lat.begin() + num / 2, lat.end());
+			float p50 = lat[num / 2];
+			std::nth_element(lat.begin(), lat.begin() + num * 99 / 100, lat.end());
+			float p99 = lat[num * 99 / 100];
+			float max_lat = *std::max_element(lat.begin(), lat.end());
+			fprintf(stderr, "Latency: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", p50, p99, max_lat);
+		}
+
+#pragma region Workers
+	protected:
+		void StartWorkers() {
+			this->is_stop = false;
+			this->task_id = 0;
+			this->threads.resize(this->thread_num);
+			this->worker_params.resize(this->thread_num);
+			//the main thread works as the first worker
+			for (int i = 1; i < this->thread_num; ++i){
+				this->worker_params[i].server = this;
+				this->worker_params[i].thread_id = i;
+#if WIN32
+				create_thread(this->threads[i], static_cast<LPTHREAD_START_ROUTINE>(PredictServer<FeatType, LabelType>::WorkerRoutine),
+					&this->worker_params[i]);
+#else
+				create_thread(this->threads[i], PredictServer<FeatType, LabelType>::WorkerRoutine,
+					&this->worker_params[i]);
+#endif
+			}
+		}
+
+		void StopWorkers() {
+			mutex_lock(&this->task_lock);
+			this->is_stop = true;
+			condition_variable_signal_all(&this->task_ready);
+			mutex_unlock(&this->task_lock);
+			for (int i = 1; i < this->thread_num; ++i){
+				join_thread(this->threads[i]);
+			}
+		}
+
+		//score the batch with all the threads, return after all finish
+		void DispatchBatch() {
+			//small batches are not worth waking up the workers
+			this->active_num = this->batch_num < (size_t)this->thread_num * 4 ? 1 : this->thread_num;
+			if (this->active_num > 1){
+				mutex_lock(&this->task_lock);
+				this->pending_num = this->thread_num - 1;
+				this->task_id++;
+				condition_variable_signal_all(&this->task_ready);
+				mutex_unlock(&this->task_lock);
+			}
+
+			this->main_predicts.resize(this->classfier_num);
+			this->ScoreLines(0, this->main_pt, this->main_predicts);
+
+			if (this->active_num > 1){
+				mutex_lock(&this->task_lock);
+				while (this->pending_num > 0){
+					condition_variable_wait(&this->task_done, &this->task_lock);
+				}
+				mutex_unlock(&this->task_lock);
+			}
+		}
+
+		void WorkerLoop(int thread_id) {
+			PointType pt;
+			vector<float> predicts(this->classfier_num);
+			size_t last_task_id = 0;
+			while (1){
+				mutex_lock(&this->task_lock);
+				while (this->task_id == last_task_id && this->is_stop == false){
+					condition_variable_wait(&this->task_ready, &this->task_lock);
+				}
+				if (this->is_stop == true){
+					mutex_unlock(&this->task_lock);
+					break;
+				}
+				last_task_id = this->task_id;
+				mutex_unlock(&this->task_lock);
+
+				this->ScoreLines(thread_id, pt, predicts);
+
+				mutex_lock(&this->task_lock);
+				if (--this->pending_num == 0){
+					condition_variable_signal(&this->task_done);
+				}
+				mutex_unlock(&this->task_lock);
+			}
+		}
+
+#if WIN32
+		static DWORD WINAPI WorkerRoutine(LPVOID param)
+#else
+		static void* WorkerRoutine(void* param)
+#endif
+		{
+			WorkerParam* worker_param = static_cast<WorkerParam*>(param);
+			worker_param->server->WorkerLoop(worker_param->thread_id);
+#if WIN32
+			return 0;
+#else
+			return NULL;
+#endif
+		}
+#pragma endregion Workers
+	};
+}
+
+#endif
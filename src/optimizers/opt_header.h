@@ -8,6 +8,9 @@
 #define HEADER_OPTIMIZER_HELPER
 
 #include "../optimizers/OnlineOptimizer.h"
+#include "../optimizers/MultiOptimizer.h"
+#include "../optimizers/HalvingOptimizer.h"
+#include "../optimizers/PredictServer.h"
 #include <string>
 
 namespace BOC{
@@ -17,6 +20,8 @@ namespace BOC{
 		static void GetOptInfo(std::string & info){
 			info.append("\nOptimizers:");
 			APPEND_INFO(info, OnlineOptimizer, FeatType, LabelType);
+			APPEND_INFO(info, MultiOptimizer, FeatType, LabelType);
+			APPEND_INFO(info, HalvingOptimizer, FeatType, LabelType);
 		}
 	};
 }
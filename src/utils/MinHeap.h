@@ -9,6 +9,7 @@
 #define HEADER_MIN_HEAP_LIST
 
 #include "s_array.h"
+#include "state_io.h"
 
 #include <new>
 #include <iostream>
@@ -182,6 +183,8 @@ namespace BOC{
 		 * UpdateHeap : update the value of the specified item and adjust heap
 		 * Note that: when value in the heap increases to the largest among all
 		 * the data, we donot move it out and move the outsite smallest in
+		 * If the heap was valid before the value changed, only the changed
+		 * items need to be updated one by one, each costs O(log K)
 		 *
 		 * @Param data_id: specified data item
 		 * @Param value: new value of the item
@@ -191,31 +194,16 @@ namespace BOC{
 		bool UpdateHeap(index_type data_id, index_type &ret_id){
 			index_type cur_pos = this->id2pos_map[data_id];
 			if (cur_pos < this->K){
-				index_type par_pos = (cur_pos - 1) / 2;
-				if (cur_pos == 0)
-					par_pos = 0;
+				index_type par_pos = cur_pos == 0 ? 0 : (cur_pos - 1) / 2;
 				//the current value decreases
-				if (this->value_list[this->pos2id_map[cur_pos]] <
+				if (this->value_list[data_id] <
 					this->value_list[this->pos2id_map[par_pos]]){
-					do{
-						//swap parent and itself
-						this->pos2id_map[cur_pos] = this->pos2id_map[par_pos];
-						this->id2pos_map[this->pos2id_map[par_pos]] = cur_pos;
-
-						this->pos2id_map[par_pos] = data_id;
-						this->id2pos_map[data_id] = par_pos;
-
-						cur_pos = par_pos;
-						if (cur_pos == 0)
-							break;
-						par_pos = (cur_pos - 1) / 2;
-					} while (par_pos >= 0 && this->value_list[this->pos2id_map[cur_pos]] <
-						this->value_list[this->pos2id_map[par_pos]]);
-
-					return false;
+					this->DecreaseKey(data_id);
 				}
 				//the current value increases
-				this->HeapAdjust(cur_pos, this->K - 1);
+				else{
+					this->IncreaseKey(data_id);
+				}
 				return false;
 			}
 			else{
@@ -237,6 +225,38 @@ namespace BOC{
 			}
 		}
 
+		/**
+		 * DecreaseKey : move an item in the heap towards the top after its
+		 * value decreases, O(log K)
+		 *
+		 * @Param data_id: specified data item, must be in the heap
+		 */
+		void DecreaseKey(index_type data_id){
+			index_type cur_pos = this->id2pos_map[data_id];
+			while (cur_pos > 0){
+				index_type par_pos = (cur_pos - 1) / 2;
+				index_type par_id = this->pos2id_map[par_pos];
+				if ((this->value_list[data_id] < this->value_list[par_id]) == false)
+					break;
+				//swap parent and itself
+				this->pos2id_map[cur_pos] = par_id;
+				this->id2pos_map[par_id] = cur_pos;
+				cur_pos = par_pos;
+			}
+			this->pos2id_map[cur_pos] = data_id;
+			this->id2pos_map[data_id] = cur_pos;
+		}
+
+		/**
+		 * IncreaseKey : move an item in the heap away from the top after its
+		 * value increases, O(log K)
+		 *
+		 * @Param data_id: specified data item, must be in the heap
+		 */
+		void IncreaseKey(index_type data_id){
+			this->HeapAdjust(this->id2pos_map[data_id], this->K - 1);
+		}
+
 	public:
 		void HeapSort(){
 			this->BuildHeap();
@@ -309,6 +329,31 @@ namespace BOC{
 		}
 
 	public:
+		/**
+		 * SaveState : save the positions of the items, to resume training
+		 */
+		void SaveState(std::ostream &os) const {
+			write_value(os, this->K);
+			write_value(os, this->data_num);
+			write_array(os, this->id2pos_map);
+			write_array(os, this->pos2id_map);
+		}
+
+		/**
+		 * LoadState : load the positions saved by SaveState
+		 *
+		 * @Param value_list: values of the items
+		 */
+		bool LoadState(state_reader &reader, const value_type* value_list){
+			reader.read_value(this->K);
+			reader.read_value(this->data_num);
+			reader.read_array(this->id2pos_map);
+			reader.read_array(this->pos2id_map);
+			this->value_list = value_list;
+			return reader.ok() && this->id2pos_map.size() == this->data_num &&
+				this->pos2id_map.size() == this->K;
+		}
+
 		/**
 		 * UpdateDataNum : increase the total data number
 		 *
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <stdexcept>
+#include <sstream>
 
 using namespace std;
 using namespace ez;
@@ -234,6 +235,77 @@ namespace BOC {
 		}
 	}
 
+	/**
+	 * SetValue: override the value of a parameter, used to train models with
+	 * different settings from the same parsed command line
+	 *
+	 * @Param param_name: flag of the parameter
+	 * @Param value: new value in string
+	 *
+	 * @Return: false if the flag is not found or the value is invalid
+	 */
+	bool Params::SetValue(const std::string& param_name, const std::string& value) {
+		char* endptr = NULL;
+		map_float_iter iter_float = this->flag2storage_float.find(param_name);
+		if (iter_float != this->flag2storage_float.end()){
+			float val = (float)(strtod(value.c_str(), &endptr));
+			if (endptr == value.c_str() || *endptr != '\0')
+				return false;
+			*(iter_float->second) = val;
+			return true;
+		}
+		map_int_iter iter_int = this->flag2storage_int.find(param_name);
+		if (iter_int != this->flag2storage_int.end()){
+			int val = (int)(strtol(value.c_str(), &endptr, 10));
+			if (endptr == value.c_str() || *endptr != '\0')
+				return false;
+			*(iter_int->second) = val;
+			return true;
+		}
+		map_bool_iter iter_bool = this->flag2storage_bool.find(param_name);
+		if (iter_bool != this->flag2storage_bool.end()){
+			string val = value;
+			ToLowerCase(val);
+			if (val != "true" && val != "false")
+				return false;
+			*(iter_bool->second) = val == "true";
+			return true;
+		}
+		map_str_iter iter_str = this->flag2storage_str.find(param_name);
+		if (iter_str != this->flag2storage_str.end()){
+			*(iter_str->second) = value;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * ValueString: get the value of a parameter in string
+	 *
+	 * @Param param_name: flag of the parameter
+	 *
+	 * @Return: value in string, which can be restored by SetValue
+	 */
+	std::string Params::ValueString(const std::string& param_name) {
+		std::ostringstream oss;
+		map_float_iter iter_float = this->flag2storage_float.find(param_name);
+		if (iter_float != this->flag2storage_float.end()){
+			oss.precision(9);
+			oss << *(iter_float->second);
+			return oss.str();
+		}
+		map_int_iter iter_int = this->flag2storage_int.find(param_name);
+		if (iter_int != this->flag2storage_int.end()){
+			oss << *(iter_int->second);
+			return oss.str();
+		}
+		map_bool_iter iter_bool = this->flag2storage_bool.find(param_name);
+		if (iter_bool != this->flag2storage_bool.end()){
+			return *(iter_bool->second) ? "true" : "false";
+		}
+		return this->StringValue(param_name);
+	}
+
 	void Params::Help() {
 		string usage;
 		option->opt.getUsageByCategory(usage);
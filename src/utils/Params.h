@@ -57,6 +57,9 @@ namespace BOC {
 		bool BoolValue(const std::string& param_name);
 		const std::string& StringValue(const std::string& param_name);
 
+		bool SetValue(const std::string& param_name, const std::string& value);
+		std::string ValueString(const std::string& param_name);
+
 	public:
 		void Init(const string& overview, const string &syntax, const string& example);
 
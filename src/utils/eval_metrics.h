@@ -0,0 +1,288 @@
+/*************************************************************************
+	> File Name: eval_metrics.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 8:36:51 PM
+	> Functions: streaming evaluation metrics of the predictions (AUC, log
+	> loss, precision, recall and confusion matrix)
+	************************************************************************/
+#ifndef HEADER_EVAL_METRICS
+#define HEADER_EVAL_METRICS
+
+#include "s_array.h"
+
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace BOC {
+	/**
+	 * The metrics are accumulated example by example in memory independent
+	 * of the number of examples, so that the predictions are not kept.
+	 *
+	 * AUC is computed from histograms of the scores of the positive and the
+	 * negative examples. The bins are the top 16 bits of the scores as
+	 * ordered integers, so that they are relatively spaced by less than 1%
+	 * for any magnitude of the scores; examples in the same bin are counted
+	 * as ties. For multiclass, AUC is the average of one class against the
+	 * rest over the classes with both positive and negative examples, and
+	 * the bins are the top 13 bits (spaced by less than 6.25%) to keep the
+	 * histograms of many classes small.
+	 *
+	 * Log loss treats the scores as logits, with the sigmoid of the score
+	 * for binary classification and the softmax of the scores otherwise.
+	 * It is only meaningful if the model is trained with the logistic loss.
+	 *
+	 * Accumulators of different threads or folds are combined with Merge.
+	 */
+	class eval_metrics {
+	protected:
+		static const int BC_BIN_BITS = 16;
+		static const int MC_BIN_BITS = 13;
+
+		//bits of the scores kept in the bins, and the bins of a classifier
+		int bin_bits;
+		size_t bin_num;
+
+		//number of classifiers, 1 for binary classification
+		int classfier_num;
+		//number of classes, the rows and columns of the confusion matrix
+		int class_num;
+		//number of examples
+		size_t data_num;
+		//number of examples with a label out of the classes, not evaluated
+		size_t invalid_num;
+		double sum_loss;
+		//confusion[true class * class_num + predicted class]
+		s_array<size_t> confusion;
+		//score histograms of each classifier
+		s_array<size_t> pos_bins;
+		s_array<size_t> neg_bins;
+
+	public:
+		eval_metrics() : bin_bits(BC_BIN_BITS), bin_num(0), classfier_num(0), class_num(0),
+			data_num(0), invalid_num(0), sum_loss(0) {
+		}
+
+		/**
+		 * @Synopsis Reset clear the metrics
+		 *
+		 * @Param classfier_num number of classifiers of the model
+		 */
+		void Reset(int classfier_num) {
+			this->classfier_num = classfier_num;
+			this->class_num = classfier_num == 1 ? 2 : classfier_num;
+			this->bin_bits = classfier_num == 1 ? BC_BIN_BITS : MC_BIN_BITS;
+			this->bin_num = size_t(1) << this->bin_bits;
+			this->data_num = 0;
+			this->invalid_num = 0;
+			this->sum_loss = 0;
+			this->confusion.resize(this->class_num * this->class_num);
+			this->confusion.zeros();
+			this->pos_bins.resize(this->bin_num * classfier_num);
+			this->pos_bins.zeros();
+			this->neg_bins.resize(this->bin_num * classfier_num);
+			this->neg_bins.zeros();
+		}
+
+		inline bool empty() const { return this->data_num == 0; }
+
+		/**
+		 * @Synopsis Add count the prediction of an example
+		 *
+		 * @Param label true label of the example, -1 or 1 for binary
+		 * classification and the class index otherwise
+		 * @Param predicts scores of each classifier
+		 * @Param predictLabel predicted label
+		 */
+		template <typename LabelType>
+		void Add(LabelType label, const float* predicts, int predictLabel) {
+			int y = this->ClassIndex((int)label);
+			if (y < 0){
+				this->invalid_num++;
+				return;
+			}
+			int y_hat = this->ClassIndex(predictLabel);
+			if (y_hat >= 0){
+				this->confusion[y * this->class_num + y_hat]++;
+			}
+			this->data_num++;
+
+			if (this->classfier_num == 1){
+				double margin = (double)predicts[0] * (label > 0 ? 1 : -1);
+				//log(1 + exp(-margin)) without overflow
+				this->sum_loss += margin > 0 ? log1p(exp(-margin)) : -margin + log1p(exp(margin));
+				size_t* bins = label > 0 ? this->pos_bins.begin : this->neg_bins.begin;
+				bins[this->Bin(predicts[0])]++;
+				return;
+			}
+
+			float max_score = predicts[0];
+			for (int k = 0; k < this->classfier_num; ++k){
+				max_score = predicts[k] > max_score ? predicts[k] : max_score;
+				size_t* bins = k == y ? this->pos_bins.begin : this->neg_bins.begin;
+				bins[k * this->bin_num + this->Bin(predicts[k])]++;
+			}
+			double sum_exp = 0;
+			for (int k = 0; k < this->classfier_num; ++k){
+				sum_exp += exp((double)predicts[k] - max_score);
+			}
+			this->sum_loss += log(sum_exp) - ((double)predicts[y] - max_score);
+		}
+
+		/**
+		 * @Synopsis Merge add the metrics of other examples
+		 *
+		 * @Param other metrics of the same number of classifiers
+		 */
+		void Merge(const eval_metrics &other) {
+			if (other.classfier_num != this->classfier_num){
+				if (this->data_num > 0 || this->invalid_num > 0){
+					fprintf(stderr, "merge metrics of different class number!\n");
+					return;
+				}
+				this->Reset(other.classfier_num);
+			}
+			this->data_num += other.data_num;
+			this->invalid_num += other.invalid_num;
+			this->sum_loss += other.sum_loss;
+			for (size_t i = 0; i < this->confusion.size(); ++i){
+				this->confusion[i] += other.confusion[i];
+			}
+			for (size_t i = 0; i < this->pos_bins.size(); ++i){
+				this->pos_bins[i] += other.pos_bins[i];
+				this->neg_bins[i] += other.neg_bins[i];
+			}
+		}
+
+		/**
+		 * @Synopsis AUC area under the ROC curve
+		 *
+		 * @Returns AUC of binary classification or the average of the
+		 * classes, -1 if no class has both positive and negative examples
+		 */
+		double AUC() const {
+			double sum_auc = 0;
+			int auc_num = 0;
+			for (int k = 0; k < this->classfier_num; ++k){
+				const size_t* pos = this->pos_bins.begin + k * this->bin_num;
+				const size_t* neg = this->neg_bins.begin + k * this->bin_num;
+				//pairs ranked correctly, ties count a half
+				double pair_num = 0;
+				double neg_below = 0;
+				double pos_num = 0;
+				for (size_t i = 0; i < this->bin_num; ++i){
+					pair_num += pos[i] * (neg_below + 0.5 * neg[i]);
+					neg_below += neg[i];
+					pos_num += pos[i];
+				}
+				if (pos_num > 0 && neg_below > 0){
+					sum_auc += pair_num / (pos_num * neg_below);
+					auc_num++;
+				}
+			}
+			return auc_num == 0 ? -1 : sum_auc / auc_num;
+		}
+
+		//average log loss
+		double LogLoss() const {
+			return this->data_num == 0 ? 0 : this->sum_loss / this->data_num;
+		}
+
+		//number of examples of class y predicted as y_hat
+		inline size_t Confusion(int y, int y_hat) const {
+			return this->confusion[y * this->class_num + y_hat];
+		}
+
+		/**
+		 * @Synopsis PrecisionRecall precision and recall of a class
+		 *
+		 * @Param y class index, 1 is the positive class of binary classification
+		 */
+		void PrecisionRecall(int y, double &precision, double &recall) const {
+			size_t predicted = 0, actual = 0;
+			for (int k = 0; k < this->class_num; ++k){
+				predicted += this->Confusion(k, y);
+				actual += this->Confusion(y, k);
+			}
+			size_t hit = this->Confusion(y, y);
+			precision = predicted == 0 ? 0 : hit / (double)predicted;
+			recall = actual == 0 ? 0 : hit / (double)actual;
+		}
+
+		/**
+		 * @Synopsis Print print the metrics
+		 *
+		 * @Param title name of the evaluated predictions, like "Test"
+		 */
+		void Print(const char* title) const {
+			printf("\n%s metrics (%lu examples):\n", title, this->data_num);
+			if (this->invalid_num > 0){
+				printf("\tskipped examples with unknown labels: %lu\n", this->invalid_num);
+			}
+			double auc = this->AUC();
+			if (auc >= 0){
+				printf("\tAUC: %.6f\n", auc);
+			}
+			printf("\tLog loss: %.6f\n", this->LogLoss());
+
+			double precision = 0, recall = 0;
+			if (this->classfier_num == 1){
+				this->PrecisionRecall(1, precision, recall);
+				printf("\tPrecision: %.6f\n\tRecall: %.6f\n\tF1: %.6f\n", precision, recall,
+					F1(precision, recall));
+				printf("\tConfusion matrix (row: true label, column: predicted label):\n");
+				printf("\t\t\t-1\t\t1\n");
+				for (int y = 0; y < 2; ++y){
+					printf("\t%d\t\t%lu\t\t%lu\n", y * 2 - 1, this->Confusion(y, 0), this->Confusion(y, 1));
+				}
+				return;
+			}
+
+			printf("\tClass\tPrecision\tRecall\t\tF1\n");
+			double sum_f1 = 0;
+			for (int y = 0; y < this->class_num; ++y){
+				this->PrecisionRecall(y, precision, recall);
+				sum_f1 += F1(precision, recall);
+				printf("\t%d\t%.6f\t%.6f\t%.6f\n", y, precision, recall, F1(precision, recall));
+			}
+			printf("\tMacro F1: %.6f\n", sum_f1 / this->class_num);
+			printf("\tConfusion matrix (row: true class, column: predicted class):\n\t");
+			for (int y_hat = 0; y_hat < this->class_num; ++y_hat){
+				printf("\t%d", y_hat);
+			}
+			printf("\n");
+			for (int y = 0; y < this->class_num; ++y){
+				printf("\t%d", y);
+				for (int y_hat = 0; y_hat < this->class_num; ++y_hat){
+					printf("\t%lu", this->Confusion(y, y_hat));
+				}
+				printf("\n");
+			}
+		}
+
+	protected:
+		//row of the label in the confusion matrix, -1 if not a class
+		inline int ClassIndex(int label) const {
+			if (this->classfier_num == 1){
+				return label == 1 ? 1 : (label == -1 ? 0 : -1);
+			}
+			return label >= 0 && label < this->class_num ? label : -1;
+		}
+
+		//the order of floats is the order of the integers with the sign bit
+		//flipped for positive values and all bits flipped for negative ones
+		inline size_t Bin(float score) const {
+			uint32_t bits;
+			std::memcpy(&bits, &score, sizeof(bits));
+			bits = (bits & 0x80000000u) != 0 ? ~bits : (bits | 0x80000000u);
+			return bits >> (32 - this->bin_bits);
+		}
+
+		static inline double F1(double precision, double recall) {
+			return precision + recall == 0 ? 0 : 2 * precision * recall / (precision + recall);
+		}
+	};
+}
+
+#endif
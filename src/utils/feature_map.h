@@ -0,0 +1,231 @@
+/*************************************************************************
+	> File Name: feature_map.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 11:05:12 PM
+	> Functions: map feature indexes to dense weight slots, the low indexes
+	> are kept and the long tail goes through a hash table
+	************************************************************************/
+#ifndef HEADER_FEATURE_MAP
+#define HEADER_FEATURE_MAP
+
+#include "config.h"
+#include "s_array.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace BOC {
+	/**
+	 * Indexes below dense_dim are mapped to themselves. Larger indexes are
+	 * counted in an open-addressing hash table, and get the next free slot
+	 * after dense_dim once they are seen promote_count times. The weights of
+	 * the models thus grow with the number of tail features instead of the
+	 * largest index.
+	 *
+	 * With the default promote_count of 1 every feature gets a slot when it
+	 * is first seen. A larger promote_count (-promote) drops the features
+	 * seen fewer times from the training examples, so their weights stay
+	 * zero until they are promoted; the dropped occurrences are counted.
+	 *
+	 * The map belongs to the training data set, which updates it in the
+	 * loader thread. The test data and the models only look it up once the
+	 * training data is read, or promote the features of a loaded model
+	 * before training.
+	 */
+	class feature_map {
+	protected:
+		struct entry {
+			IndexType key; //feature index, 0 for empty entries
+			IndexType slot; //mapped index, 0 if not promoted yet
+			uint32_t count; //number of occurrences before promotion
+		};
+
+		//indexes below are not mapped, 0 to disable the map
+		IndexType dense_dim;
+		//number of occurrences before a feature gets a slot
+		uint32_t promote_count;
+
+		s_array<entry> table;
+		//the table has 2^table_bits entries
+		int table_bits;
+		size_t entry_num;
+		//feature index of each promoted slot
+		std::vector<IndexType> tail_index;
+		//occurrences of tail features dropped from the training examples
+		size_t drop_num;
+
+	public:
+		feature_map() : dense_dim(0), promote_count(1), table_bits(0), entry_num(0), drop_num(0) {
+		}
+
+		/**
+		 * @Synopsis config set the size of the dense part and the promotion
+		 * threshold, clears the map
+		 *
+		 * @Param dense_dim indexes below are not mapped, 0 to disable the map
+		 * @Param promote_count number of occurrences before a tail feature
+		 * gets a slot
+		 */
+		void config(IndexType dense_dim, uint32_t promote_count) {
+			this->dense_dim = dense_dim;
+			this->promote_count = promote_count > 0 ? promote_count : 1;
+			this->table_bits = dense_dim > 0 ? 10 : 0;
+			this->table.resize(dense_dim > 0 ? (size_t)1 << this->table_bits : 0);
+			this->table.zeros();
+			this->entry_num = 0;
+			this->tail_index.clear();
+			this->drop_num = 0;
+		}
+
+		inline bool enabled() const { return this->dense_dim > 0; }
+		inline IndexType get_dense_dim() const { return this->dense_dim; }
+		//number of tail features seen
+		inline size_t tail_num() const { return this->entry_num; }
+		//number of tail features with a slot
+		inline size_t promoted_num() const { return this->tail_index.size(); }
+		//occurrences of tail features dropped before promotion
+		inline size_t dropped_num() const { return this->drop_num; }
+
+		//feature index of a slot
+		inline IndexType raw_index(IndexType slot) const {
+			return slot < this->dense_dim ? slot : this->tail_index[slot - this->dense_dim];
+		}
+
+		/**
+		 * @Synopsis map_train map an index of a training example, the
+		 * occurrence is counted
+		 *
+		 * @Returns the slot, 0 if the feature is not promoted yet
+		 */
+		inline IndexType map_train(IndexType index) {
+			if (index < this->dense_dim)
+				return index;
+			entry &e = this->find(index, true);
+			if (e.slot == 0 && ++e.count >= this->promote_count){
+				this->assign_slot(e);
+			}
+			return e.slot;
+		}
+
+		/**
+		 * @Synopsis map_test map an index of a test example, nothing is changed
+		 *
+		 * @Returns the slot, 0 if the feature has no slot
+		 */
+		inline IndexType map_test(IndexType index) const {
+			if (index < this->dense_dim)
+				return index;
+			const entry &e = const_cast<feature_map*>(this)->find(index, false);
+			return e.key == index ? e.slot : 0;
+		}
+
+		//get the slot of a feature, a slot is assigned if it has none
+		IndexType promote(IndexType index) {
+			if (index < this->dense_dim)
+				return index;
+			entry &e = this->find(index, true);
+			if (e.slot == 0){
+				this->assign_slot(e);
+			}
+			return e.slot;
+		}
+
+		/**
+		 * @Synopsis map_point map the indexes of an example, the features
+		 * without a slot are removed
+		 *
+		 * @Param pt the example
+		 * @Param is_train whether the occurrences are counted
+		 */
+		template <typename PointType>
+		void map_point(PointType &pt, bool is_train) {
+			size_t featNum = pt.indexes.size();
+			size_t j = 0;
+			bool is_sorted = true;
+			pt.max_index = 0;
+			for (size_t i = 0; i < featNum; ++i){
+				IndexType slot = is_train ? this->map_train(pt.indexes[i]) : this->map_test(pt.indexes[i]);
+				if (slot == 0){
+					pt.sum_sq -= pt.features[i] * pt.features[i];
+					this->drop_num += is_train;
+					continue;
+				}
+				if (slot < pt.max_index){
+					is_sorted = false;
+				}
+				else{
+					pt.max_index = slot;
+				}
+				pt.indexes[j] = slot;
+				pt.features[j] = pt.features[i];
+				++j;
+			}
+			pt.indexes.resize(j);
+			pt.features.resize(j);
+			if (is_sorted == false){
+				pt.Sort();
+			}
+		}
+
+		//map the indexes of an example without changing the map
+		template <typename PointType>
+		inline void lookup_point(PointType &pt) const {
+			const_cast<feature_map*>(this)->map_point(pt, false);
+		}
+
+	protected:
+		//Fibonacci hashing, the top bits of the product depend on all the bits
+		//of the index, so that strided indexes are spread over the table
+		inline size_t hash(IndexType index) const {
+			return (size_t)(((uint64_t)index * 0x9E3779B97F4A7C15ull) >> (64 - this->table_bits));
+		}
+
+		//find the entry of an index, or the empty entry to insert it
+		entry& find(IndexType index, bool is_insert) {
+			size_t mask = this->table.size() - 1;
+			size_t pos = this->hash(index);
+			while (this->table[pos].key != 0 && this->table[pos].key != index){
+				pos = (pos + 1) & mask;
+			}
+			entry &e = this->table[pos];
+			if (e.key == 0 && is_insert == true){
+				//keep the load factor below 1/2
+				if ((this->entry_num + 1) * 2 > this->table.size()){
+					this->rehash(this->table_bits + 1);
+					return this->find(index, true);
+				}
+				e.key = index;
+				e.slot = 0;
+				e.count = 0;
+				this->entry_num++;
+			}
+			return e;
+		}
+
+		void assign_slot(entry &e) {
+			e.slot = (IndexType)(this->dense_dim + this->tail_index.size());
+			this->tail_index.push_back(e.key);
+		}
+
+		void rehash(int new_bits) {
+			s_array<entry> old_table;
+			old_table.resize(this->table.size());
+			std::memcpy(old_table.begin, this->table.begin, sizeof(entry) * this->table.size());
+			this->table_bits = new_bits;
+			this->table.resize((size_t)1 << new_bits);
+			this->table.zeros();
+			size_t mask = this->table.size() - 1;
+			for (entry *p = old_table.begin; p != old_table.end; ++p){
+				if (p->key == 0)
+					continue;
+				size_t pos = this->hash(p->key);
+				while (this->table[pos].key != 0){
+					pos = (pos + 1) & mask;
+				}
+				this->table[pos] = *p;
+			}
+		}
+	};
+}
+
+#endif
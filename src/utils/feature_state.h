@@ -0,0 +1,301 @@
+/*************************************************************************
+	> File Name: feature_state.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 10:12:31 PM
+	> Functions: per-feature states of models, interleaved (AoS) or in
+	> separate arrays (SoA), in 32-bit or bfloat16 precision
+	************************************************************************/
+#ifndef HEADER_FEATURE_STATE
+#define HEADER_FEATURE_STATE
+
+#include "s_array.h"
+#include "state_io.h"
+
+#include <stdint.h>
+
+#include <string>
+
+namespace BOC {
+	//a field of the state, a real value or a 32-bit counter
+	union state_field {
+		float real;
+		uint32_t count;
+	};
+
+	//a real value in bfloat16, the upper 16 bits of a float
+	struct bf16_field {
+		uint16_t bits;
+	};
+
+	inline float field_value(const state_field &field) {
+		return field.real;
+	}
+
+	inline void set_field_value(state_field &field, float val, uint32_t &rand_state) {
+		field.real = val;
+	}
+
+	inline float field_value(const bf16_field &field) {
+		state_field ret;
+		ret.count = (uint32_t)field.bits << 16;
+		return ret.real;
+	}
+
+	/**
+	 * @Synopsis set_field_value store a float in bfloat16 with stochastic
+	 * rounding: a random number is added to the dropped 16 bits, so that the
+	 * stored value is unbiased and small updates are not lost
+	 *
+	 * @Param rand_state state of the xorshift random number generator
+	 */
+	inline void set_field_value(bf16_field &field, float val, uint32_t &rand_state) {
+		rand_state ^= rand_state << 13;
+		rand_state ^= rand_state >> 17;
+		rand_state ^= rand_state << 5;
+		state_field f;
+		f.real = val;
+		//keep inf and nan
+		if ((f.count & 0x7F800000) != 0x7F800000){
+			uint32_t rounded = f.count + (rand_state & 0xFFFF);
+			//do not round up to inf
+			if ((rounded & 0x7F800000) != 0x7F800000){
+				f.count = rounded;
+			}
+		}
+		field.bits = (uint16_t)(f.count >> 16);
+	}
+
+	/**
+	 * N fields are kept for each feature, like the weight, the sum of squared
+	 * gradients and the time stamp. In the AoS layout, the fields of a feature
+	 * are stored together, so that touching a feature costs one cache miss
+	 * instead of N. In the SoA layout, each field is a separate array. The
+	 * layout only changes the strides, so the accessors have no branch.
+	 *
+	 * Field is state_field for 32-bit fields, or bf16_field to halve the memory
+	 * of real values, which are then accessed only by get and set.
+	 *
+	 * For multiclass models, the fields are repeated for each class (group),
+	 * except the first shared_num ones, like a time stamp, which are kept once
+	 * for all the classes. The fields of group g are accessed with the extra
+	 * argument g, shared fields with g = 0.
+	 */
+	template <int N, typename Field = state_field>
+	class feature_state {
+	protected:
+		s_array<Field> data;
+		//number of features
+		size_t dim;
+		//number of fields of a feature, shared fields and those of each group
+		size_t field_num;
+		//distance between the same field of two groups
+		size_t group_stride;
+		int group_num;
+		int shared_num;
+		//number of features the SoA arrays can hold
+		size_t capacity;
+		bool is_aos;
+		//distance between two features and between two fields
+		size_t feat_stride;
+		size_t field_stride;
+		//random state of the stochastic rounding
+		uint32_t rand_state;
+
+	public:
+		feature_state() : dim(0), field_num(N), group_stride(0), group_num(1), shared_num(0),
+			capacity(0), is_aos(true), feat_stride(N), field_stride(1), rand_state(2463534242u) {
+		}
+
+		inline size_t size() const { return this->dim; }
+		inline bool aos() const { return this->is_aos; }
+		inline const char* layout_name() const { return this->is_aos ? "aos" : "soa"; }
+
+		inline float& real(size_t i, int k, int g = 0) {
+			return this->field(i, k, g).real;
+		}
+		inline float real(size_t i, int k, int g = 0) const {
+			return const_cast<feature_state*>(this)->field(i, k, g).real;
+		}
+		inline uint32_t& count(size_t i, int k, int g = 0) {
+			return this->field(i, k, g).count;
+		}
+		inline uint32_t count(size_t i, int k, int g = 0) const {
+			return const_cast<feature_state*>(this)->field(i, k, g).count;
+		}
+
+		//real value of the k-th field of the i-th feature in any precision
+		inline float get(size_t i, int k, int g = 0) const {
+			return field_value(const_cast<feature_state*>(this)->field(i, k, g));
+		}
+		inline void set(size_t i, int k, float val) {
+			set_field_value(this->field(i, k, 0), val, this->rand_state);
+		}
+		inline void set(size_t i, int k, int g, float val) {
+			set_field_value(this->field(i, k, g), val, this->rand_state);
+		}
+
+		//the k-th field of feature 0 and the distance between two features,
+		//to read a 32-bit real field with sparse_dot_strided
+		inline const float* real_begin(int k, int g = 0) const {
+			return &const_cast<feature_state*>(this)->field(0, k, g).real;
+		}
+		inline size_t stride() const { return this->feat_stride; }
+
+		//prefetch the fields of a feature
+		inline void prefetch(size_t i) const {
+#ifdef __GNUC__
+			const Field* p = this->data.begin + i * this->feat_stride;
+			if (this->is_aos == true){
+				__builtin_prefetch(p);
+				__builtin_prefetch(p + this->field_num - 1);
+				return;
+			}
+			for (size_t k = 0; k < this->field_num; ++k){
+				__builtin_prefetch(p + k * this->field_stride);
+			}
+#endif
+		}
+
+		/**
+		 * @Synopsis set_groups repeat the fields for each group, the states
+		 * are cleared
+		 *
+		 * @Param group_num number of groups, like the number of classes
+		 * @Param shared_num number of the first fields shared by the groups
+		 */
+		void set_groups(int group_num, int shared_num) {
+			this->field_num = shared_num + (size_t)(N - shared_num) * group_num;
+			this->group_stride = N - shared_num;
+			this->group_num = group_num;
+			this->shared_num = shared_num;
+			this->dim = 0;
+			this->capacity = 0;
+			this->data.erase();
+			this->feat_stride = this->is_aos ? this->field_num : 1;
+			this->field_stride = 1;
+		}
+
+		/**
+		 * @Synopsis resize change the number of features, the states of the
+		 * existing features are kept and the new ones are set to zero
+		 */
+		void resize(size_t new_dim) {
+			if (new_dim <= this->dim){
+				this->dim = new_dim;
+				return;
+			}
+			if (this->is_aos == true){
+				this->data.resize(new_dim * this->field_num);
+				this->data.zeros(this->data.begin + this->dim * this->field_num, this->data.end);
+			}
+			else if (new_dim <= this->capacity){
+				for (size_t k = 0; k < this->field_num; ++k){
+					Field* p = this->data.begin + k * this->capacity;
+					this->data.zeros(p + this->dim, p + new_dim);
+				}
+			}
+			else{
+				//enlarge the arrays of SoA, the new states are zero
+				this->relayout(false, new_dim + new_dim / 2);
+			}
+			this->dim = new_dim;
+		}
+
+		/**
+		 * @Synopsis set_layout change the layout, the states are kept
+		 *
+		 * @Param layout "aos" or "soa"
+		 *
+		 * @Returns false if the layout is unknown
+		 */
+		bool set_layout(const std::string &layout) {
+			if (layout == "aos"){
+				this->relayout(true, this->dim);
+			}
+			else if (layout == "soa"){
+				this->relayout(false, this->dim);
+			}
+			else{
+				return false;
+			}
+			return true;
+		}
+
+		//set all the fields to zero
+		void zeros() {
+			this->data.zeros();
+		}
+
+		//save the layout and the fields, to resume training
+		void save(std::ostream &os) const {
+			write_value(os, (uint64_t)this->dim);
+			write_value(os, (uint64_t)this->field_num);
+			write_value(os, (uint64_t)this->capacity);
+			write_value(os, this->group_num);
+			write_value(os, this->shared_num);
+			write_value(os, this->is_aos);
+			write_value(os, this->rand_state);
+			write_array(os, this->data);
+		}
+
+		//load the states saved by save, the layout is restored as well
+		bool load(state_reader &reader) {
+			uint64_t dim = 0, field_num = 0, capacity = 0;
+			reader.read_value(dim);
+			reader.read_value(field_num);
+			reader.read_value(capacity);
+			reader.read_value(this->group_num);
+			reader.read_value(this->shared_num);
+			reader.read_value(this->is_aos);
+			reader.read_value(this->rand_state);
+			reader.read_array(this->data);
+			if (reader.ok() == false || field_num != this->shared_num +
+				(size_t)(N - this->shared_num) * this->group_num){
+				return false;
+			}
+			this->dim = (size_t)dim;
+			this->field_num = (size_t)field_num;
+			this->capacity = (size_t)capacity;
+			this->group_stride = N - this->shared_num;
+			this->feat_stride = this->is_aos ? this->field_num : 1;
+			this->field_stride = this->is_aos ? 1 : this->capacity;
+			return this->data.size() >= (this->is_aos ? this->dim : this->capacity) * this->field_num;
+		}
+
+		//set the k-th field of all the features and groups
+		void set_real(int k, float val) {
+			int group_num = k < this->shared_num ? 1 : this->group_num;
+			for (size_t i = 0; i < this->dim; ++i){
+				for (int g = 0; g < group_num; ++g){
+					this->set(i, k, g, val);
+				}
+			}
+		}
+
+	protected:
+		inline Field& field(size_t i, int k, int g) {
+			return this->data.begin[i * this->feat_stride + (k + g * this->group_stride) * this->field_stride];
+		}
+
+		void relayout(bool aos, size_t new_capacity) {
+			s_array<Field> new_data;
+			new_data.resize((aos ? this->dim : new_capacity) * this->field_num);
+			new_data.zeros();
+			size_t new_feat_stride = aos ? this->field_num : 1;
+			size_t new_field_stride = aos ? 1 : new_capacity;
+			for (size_t i = 0; i < this->dim; ++i){
+				for (size_t k = 0; k < this->field_num; ++k){
+					new_data.begin[i * new_feat_stride + k * new_field_stride] =
+						this->data.begin[i * this->feat_stride + k * this->field_stride];
+				}
+			}
+			this->data = new_data;
+			this->is_aos = aos;
+			this->capacity = aos ? 0 : new_capacity;
+			this->feat_stride = new_feat_stride;
+			this->field_stride = new_field_stride;
+		}
+	};
+}
+
+#endif
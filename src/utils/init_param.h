@@ -64,6 +64,21 @@ namespace BOC {
 	static const char* const init_algo_method = "SGD";
 	static const char* const init_data_reader_type = "online"; //init data reader type
 	static const char* const init_opt_type = "opt_online"; //init multi-pass type
+	static const int init_batch_size = 1; //number of examples in a mini-batch
+	static const int init_thread_num = 0; //number of training threads, 0 for the number of processors
+	static const int init_halving_budget = 1024; //number of examples of the first rung in successive halving
+	static const char* const init_sparse_kernel = "auto"; //kernel of sparse dot product and update
+	static const char* const init_state_layout = "aos"; //layout of the per-feature states of models
+	static const char* const init_state_precision = "fp32"; //precision of the per-feature states of models
+	static const int init_dense_dim = 0; //indexes below are stored densely, larger ones are hashed, 0 to disable
+	static const int init_promote_count = 1; //occurrences before a hashed feature gets a weight, the rarer ones are dropped
+	static const char* const init_model_format = "binary"; //format of the saved models, binary or text
+	static const int init_serve_batch = 64; //maximum number of examples scored together in serving
+	static const int init_serve_wait = 1; //milliseconds an example waits for others to be scored together
+	static const int init_ckpt_every = 0; //examples between two checkpoints, 0 to disable
+	static const float init_ckpt_secs = 600; //seconds between two checkpoints, 0 to disable
+	static const int init_metrics_every = 0; //examples between two telemetry records, 0 to disable
+	static const float init_metrics_secs = 10; //seconds between two telemetry records, 0 to disable
 
 	//trying the optimal parameters
 	////////////////////Data Set Reader Parameters///////////////////////////
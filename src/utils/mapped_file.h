@@ -0,0 +1,115 @@
+/*************************************************************************
+	> File Name: mapped_file.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 12:36:08 AM
+	> Functions: read-only view of a file, mapped to memory if supported
+	************************************************************************/
+#ifndef HEADER_MAPPED_FILE
+#define HEADER_MAPPED_FILE
+
+#include <cstdio>
+#include <string>
+
+#if WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace BOC {
+	/**
+	 * The file is mapped privately, so the pages can be modified in memory
+	 * without changing the file, and are copied only when written. Where mmap
+	 * is not available, the file is read into memory.
+	 */
+	class mapped_file {
+	protected:
+		char* data;
+		size_t length;
+		bool is_mapped;
+
+	public:
+		mapped_file() : data(NULL), length(0), is_mapped(false) {
+		}
+
+		~mapped_file() {
+			this->close();
+		}
+
+		inline char* begin() const { return this->data; }
+		inline size_t size() const { return this->length; }
+		inline bool is_open() const { return this->data != NULL; }
+
+		/**
+		 * @Synopsis open map the file to memory
+		 *
+		 * @Param filename path of the file
+		 *
+		 * @Returns false if the file can not be opened or is empty
+		 */
+		bool open(const std::string &filename) {
+			this->close();
+#if WIN32
+			std::ifstream infile(filename.c_str(), std::ios::in | std::ios::binary);
+			if (!infile){
+				return false;
+			}
+			infile.seekg(0, std::ios::end);
+			this->length = (size_t)infile.tellg();
+			infile.seekg(0, std::ios::beg);
+			if (this->length == 0){
+				return false;
+			}
+			this->data = new char[this->length];
+			infile.read(this->data, this->length);
+			this->is_mapped = false;
+			return infile.good();
+#else
+			int fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0){
+				return false;
+			}
+			struct stat st;
+			if (fstat(fd, &st) != 0 || st.st_size == 0){
+				::close(fd);
+				return false;
+			}
+			void* addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (addr == MAP_FAILED){
+				return false;
+			}
+			this->data = (char*)addr;
+			this->length = (size_t)st.st_size;
+			this->is_mapped = true;
+			return true;
+#endif
+		}
+
+		void close() {
+			if (this->data != NULL){
+#if !WIN32
+				if (this->is_mapped == true){
+					munmap(this->data, this->length);
+				}
+				else
+#endif
+				{
+					delete[]this->data;
+				}
+			}
+			this->data = NULL;
+			this->length = 0;
+			this->is_mapped = false;
+		}
+
+	private:
+		mapped_file(const mapped_file&);
+		mapped_file& operator=(const mapped_file&);
+	};
+}
+
+#endif
@@ -72,6 +72,10 @@ namespace BOC{
 			return NULL;
 		}
 
+		static bool IsRegistered(const std::string &name){
+			return mapClassInfo.find(name) != mapClassInfo.end();
+		}
+
 		virtual const std::string& GetType() const = 0;
 		virtual const std::string& GetDescription() const = 0;
 	};
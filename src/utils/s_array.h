@@ -24,6 +24,7 @@ namespace BOC{
 		T* end; //point to the next postion of the last element
 		size_t capacity; //capacity of the array
 		int *count;
+		bool is_owner; //whether the elements are freed by the array
 
 		T first() const { return *begin; }
 		T last() const { return *(end - 1); }
@@ -55,8 +56,9 @@ namespace BOC{
 			size_t old_len = this->size();
 			//copy data
 			std::memcpy(new_begin, begin, sizeof(T)* old_len);
-			if (begin != NULL)
+			if (begin != NULL && is_owner == true)
 				delete[]begin;
+			is_owner = true;
 			begin = new_begin;
 			end = begin + old_len;
 			capacity = new_size;
@@ -100,10 +102,29 @@ namespace BOC{
 			this->end = arr.end;
 			this->capacity = arr.capacity;
 			this->count = arr.count;
+			this->is_owner = arr.is_owner;
 			++(*count);
 			return *this;
 		}
 
+		/**
+		 * @Synopsis attach use external memory as the elements, like a memory
+		 * mapped file, the memory is not freed by the array. It is copied to
+		 * the array's own memory when the array grows beyond len
+		 *
+		 * @Param data the elements
+		 * @Param len number of elements
+		 */
+		void attach(T* data, size_t len) {
+			this->release();
+			this->count = new int;
+			*this->count = 1;
+			this->begin = data;
+			this->end = data + len;
+			this->capacity = len;
+			this->is_owner = false;
+		}
+
 		//reset all the elements in the array to zero
 		void zeros(){
 			std::memset(this->begin, 0, sizeof(T)* this->size());
@@ -140,7 +161,7 @@ namespace BOC{
 		void release() {
 			--(*count);
 			if (*count == 0) {
-				if (this->begin != NULL)
+				if (this->begin != NULL && this->is_owner == true)
 					delete[]this->begin;
 				delete this->count;
 			}
@@ -152,6 +173,7 @@ namespace BOC{
 
 		s_array() {
 			begin = NULL; end = NULL; count = NULL; capacity = 0;
+			is_owner = true;
 			count = new int;
 			*count = 1;
 		}
@@ -160,6 +182,7 @@ namespace BOC{
 			this->end = arr.end;
 			this->capacity = arr.capacity;
 			this->count = arr.count;
+			this->is_owner = arr.is_owner;
 			++(*count);
 		}
 
@@ -0,0 +1,179 @@
+/*************************************************************************
+	> File Name: scaled_array.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 9:26:40 PM
+	> Functions: array with a global scale factor and a running squared norm
+	************************************************************************/
+#ifndef HEADER_SCALED_ARRAY
+#define HEADER_SCALED_ARRAY
+
+#include "s_array.h"
+#include "sparse_kernel.h"
+#include "state_io.h"
+
+#include <cmath>
+
+namespace BOC {
+	/**
+	 * the elements are scale * values[i], so that multiplying the whole array
+	 * is O(1). The squared L2 norm of the elements is updated with each change
+	 * if required. The scale is folded into the values when it gets too small or
+	 * too large, and periodically to remove the accumulated rounding error of
+	 * the running norm, costing O(d) amortized over at least d updates.
+	 *
+	 * The values are kept in an external s_array, so that they can be used
+	 * directly where the scale is known, like the weight vectors of models.
+	 */
+	template <typename T>
+	class scaled_array {
+	protected:
+		s_array<T> *values;
+		T scale;
+		//squared L2 norm of the elements
+		double sq_norm;
+		bool is_track_norm;
+		//number of updates since the last normalization
+		size_t update_num;
+
+	public:
+		scaled_array() : values(NULL), scale(1), sq_norm(0), is_track_norm(false), update_num(0) {
+		}
+
+		/**
+		 * @Synopsis attach use the array as the values, scale is set to 1
+		 *
+		 * @Param vec values of the elements
+		 * @Param track_norm whether to update the squared norm with each change
+		 */
+		void attach(s_array<T> &vec, bool track_norm) {
+			this->values = &vec;
+			this->scale = 1;
+			this->is_track_norm = track_norm;
+			this->normalize();
+		}
+
+		inline T get_scale() const { return this->scale; }
+		inline double norm2() const { return this->sq_norm; }
+
+		//get the i-th element
+		inline T get(size_t i) const { return this->scale * (*this->values)[i]; }
+
+		//set the i-th element
+		inline void set(size_t i, T val) {
+			T &v = (*this->values)[i];
+			if (this->is_track_norm == true){
+				T old_val = this->scale * v;
+				this->sq_norm += (double)val * val - (double)old_val * old_val;
+			}
+			v = val / this->scale;
+			this->count_update(1);
+		}
+
+		//add delta to the i-th element
+		inline void add(size_t i, T delta) {
+			this->set(i, this->get(i) + delta);
+		}
+
+		/**
+		 * @Synopsis add_sparse elements[idx[i]] += a * x[i], O(nnz)
+		 *
+		 * @Param is_strict if the indexes pass sparse_is_strict
+		 * @Param gathered values[idx[i]] gathered before and not changed, can be NULL
+		 */
+		template <typename FeatType>
+		inline void add_sparse(T a, const IndexType* idx, const FeatType* x, size_t n,
+			bool is_strict, const float* gathered) {
+			T a_v = a / this->scale;
+			//the gathered weights miss the earlier updates of duplicated indexes
+			if (is_strict == false){
+				gathered = NULL;
+			}
+			if (this->is_track_norm == false){
+				sparse_axpy(a_v, idx, x, n, is_strict, gathered, this->values->begin);
+			}
+			else{
+				T* v = this->values->begin;
+				double scale2 = (double)this->scale * this->scale;
+				double delta = 0;
+				for (size_t i = 0; i < n; ++i){
+					T old_v = gathered == NULL ? v[idx[i]] : gathered[i];
+					T new_v = old_v + a_v * x[i];
+					delta += (double)new_v * new_v - (double)old_v * old_v;
+					v[idx[i]] = new_v;
+				}
+				this->sq_norm += delta * scale2;
+			}
+			this->count_update(n);
+		}
+
+		//multiply all the elements by c, O(1)
+		inline void multiply(T c) {
+			if (c == 0){
+				this->values->zeros();
+				this->scale = 1;
+				this->sq_norm = 0;
+				this->update_num = 0;
+				return;
+			}
+			this->scale *= c;
+			this->sq_norm *= (double)c * c;
+			if (std::fabs(this->scale) < 1e-10f || std::fabs(this->scale) > 1e10f){
+				this->normalize();
+			}
+		}
+
+		/**
+		 * @Synopsis normalize fold the scale into the values and compute the
+		 * squared norm exactly, O(d)
+		 */
+		void normalize() {
+			T* p = this->values->begin;
+			T* p_end = this->values->end;
+			double norm = 0;
+			if (this->scale != 1){
+				for (; p != p_end; ++p){
+					*p *= this->scale;
+					norm += (double)(*p) * (*p);
+				}
+			}
+			else if (this->is_track_norm == true){
+				for (; p != p_end; ++p){
+					norm += (double)(*p) * (*p);
+				}
+			}
+			this->scale = 1;
+			this->sq_norm = norm;
+			this->update_num = 0;
+		}
+
+		/**
+		 * @Synopsis save save the scale and the norm, the values are saved
+		 * by the owner of the array
+		 */
+		void save(std::ostream &os) const {
+			write_value(os, this->scale);
+			write_value(os, this->sq_norm);
+			write_value(os, (uint64_t)this->update_num);
+		}
+
+		//load the scale and the norm saved by save, after the values are attached
+		bool load(state_reader &reader) {
+			uint64_t update_num = 0;
+			reader.read_value(this->scale);
+			reader.read_value(this->sq_norm);
+			reader.read_value(update_num);
+			this->update_num = (size_t)update_num;
+			return reader.ok();
+		}
+
+	protected:
+		inline void count_update(size_t n) {
+			this->update_num += n;
+			if (this->is_track_norm == true && this->update_num > this->values->size()){
+				this->normalize();
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,380 @@
+/*************************************************************************
+	> File Name: sparse_kernel.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/19/2026 7:12:05 PM
+	> Functions: kernels of sparse dot product and sparse update, the
+	> scalar, AVX2 or AVX-512 version is selected at runtime
+	************************************************************************/
+#ifndef HEADER_SPARSE_KERNEL
+#define HEADER_SPARSE_KERNEL
+
+#include "config.h"
+
+#include <climits>
+#include <cstring>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOL_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace BOC {
+	/**
+	 * @Synopsis sparse dot product of weights and an example
+	 *
+	 * @Param w weight vector
+	 * @Param idx indexes of the example
+	 * @Param x features of the example
+	 * @Param n number of features
+	 * @Param gathered if not NULL, the gathered weights w[idx[i]] are kept here
+	 *
+	 * @Returns sum of w[idx[i]] * x[i]
+	 */
+	typedef float(*sparse_dot_func)(const float* w, const IndexType* idx, const float* x,
+		size_t n, float* gathered);
+
+	/**
+	 * @Synopsis sparse update of weights: w[idx[i]] += a * x[i], the vector
+	 * kernels require the indexes to pass sparse_is_strict
+	 *
+	 * @Param gathered if not NULL, weights gathered by sparse_dot_func and not
+	 * changed since then, so that they are not gathered again
+	 */
+	typedef void(*sparse_axpy_func)(float a, const IndexType* idx, const float* x,
+		size_t n, const float* gathered, float* w);
+
+	/**
+	 * @Synopsis sparse dot product of strided weights and an example, like a
+	 * field of the per-feature states
+	 *
+	 * @Param w the field of the first feature
+	 * @Param stride distance between the fields of two features
+	 *
+	 * @Returns sum of w[idx[i] * stride] * x[i]
+	 */
+	typedef float(*sparse_dot_strided_func)(const float* w, size_t stride, const IndexType* idx,
+		const float* x, size_t n);
+
+	struct SparseKernel {
+		const char* name;
+		sparse_dot_func dot;
+		sparse_axpy_func axpy;
+		sparse_dot_strided_func dot_strided;
+	};
+
+	/**
+	 * @Synopsis sparse_is_strict check if the indexes are strictly increasing
+	 * and fit the signed 32-bit offsets of gather and scatter, otherwise the
+	 * example is processed by the scalar kernels, which sum the updates of
+	 * duplicated indexes
+	 */
+	inline bool sparse_is_strict(const IndexType* idx, size_t n){
+		for (size_t i = 1; i < n; ++i){
+			if (idx[i] <= idx[i - 1]){
+				return false;
+			}
+		}
+		return n == 0 || (size_t)idx[n - 1] <= (size_t)INT_MAX;
+	}
+
+#pragma region Scalar Kernels
+	inline float sparse_dot_scalar(const float* w, const IndexType* idx, const float* x,
+		size_t n, float* gathered){
+		float sum = 0;
+		if (gathered == NULL){
+			for (size_t i = 0; i < n; ++i){
+				sum += w[idx[i]] * x[i];
+			}
+		}
+		else{
+			for (size_t i = 0; i < n; ++i){
+				gathered[i] = w[idx[i]];
+				sum += gathered[i] * x[i];
+			}
+		}
+		return sum;
+	}
+
+	inline void sparse_axpy_scalar(float a, const IndexType* idx, const float* x,
+		size_t n, const float* gathered, float* w){
+		if (gathered == NULL){
+			for (size_t i = 0; i < n; ++i){
+				w[idx[i]] += a * x[i];
+			}
+		}
+		else{
+			for (size_t i = 0; i < n; ++i){
+				w[idx[i]] = gathered[i] + a * x[i];
+			}
+		}
+	}
+
+	inline float sparse_dot_strided_scalar(const float* w, size_t stride, const IndexType* idx,
+		const float* x, size_t n){
+		float sum = 0;
+		for (size_t i = 0; i < n; ++i){
+			sum += w[idx[i] * stride] * x[i];
+		}
+		return sum;
+	}
+#pragma endregion Scalar Kernels
+
+#ifdef SOL_SIMD_X86
+#pragma region AVX2 Kernels
+	__attribute__((target("avx2,fma")))
+	inline float sparse_dot_avx2(const float* w, const IndexType* idx, const float* x,
+		size_t n, float* gathered){
+		__m256 acc = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8){
+			__m256i vi = _mm256_loadu_si256((const __m256i*)(idx + i));
+			__m256 vw = _mm256_i32gather_ps(w, vi, 4);
+			if (gathered != NULL){
+				_mm256_storeu_ps(gathered + i, vw);
+			}
+			acc = _mm256_fmadd_ps(vw, _mm256_loadu_ps(x + i), acc);
+		}
+		__m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+		sum4 = _mm_hadd_ps(sum4, sum4);
+		sum4 = _mm_hadd_ps(sum4, sum4);
+		float sum = _mm_cvtss_f32(sum4);
+		return sum + sparse_dot_scalar(w, idx + i, x + i, n - i,
+			gathered == NULL ? NULL : gathered + i);
+	}
+
+	//AVX2 has no scatter, the new weights are computed in vector and stored one by one
+	__attribute__((target("avx2,fma")))
+	inline void sparse_axpy_avx2(float a, const IndexType* idx, const float* x,
+		size_t n, const float* gathered, float* w){
+		__m256 va = _mm256_set1_ps(a);
+		float buf[8];
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8){
+			__m256 vw;
+			if (gathered != NULL){
+				vw = _mm256_loadu_ps(gathered + i);
+			}
+			else{
+				vw = _mm256_i32gather_ps(w, _mm256_loadu_si256((const __m256i*)(idx + i)), 4);
+			}
+			_mm256_storeu_ps(buf, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), vw));
+			for (int j = 0; j < 8; ++j){
+				w[idx[i + j]] = buf[j];
+			}
+		}
+		sparse_axpy_scalar(a, idx + i, x + i, n - i, gathered == NULL ? NULL : gathered + i, w);
+	}
+
+	//the offsets idx[i] * stride are computed in 64 bits, so any index is valid
+	__attribute__((target("avx2,fma")))
+	inline float sparse_dot_strided_avx2(const float* w, size_t stride, const IndexType* idx,
+		const float* x, size_t n){
+		__m256 acc = _mm256_setzero_ps();
+		__m256i vs = _mm256_set1_epi64x((long long)stride);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8){
+			__m256i vi = _mm256_loadu_si256((const __m256i*)(idx + i));
+			__m256i lo = _mm256_mul_epu32(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(vi)), vs);
+			__m256i hi = _mm256_mul_epu32(_mm256_cvtepu32_epi64(_mm256_extracti128_si256(vi, 1)), vs);
+			__m256 vw = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_i64gather_ps(w, lo, 4)),
+				_mm256_i64gather_ps(w, hi, 4), 1);
+			acc = _mm256_fmadd_ps(vw, _mm256_loadu_ps(x + i), acc);
+		}
+		__m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+		sum4 = _mm_hadd_ps(sum4, sum4);
+		sum4 = _mm_hadd_ps(sum4, sum4);
+		float sum = _mm_cvtss_f32(sum4);
+		return sum + sparse_dot_strided_scalar(w, stride, idx + i, x + i, n - i);
+	}
+#pragma endregion AVX2 Kernels
+
+#pragma region AVX-512 Kernels
+	__attribute__((target("avx512f")))
+	inline float sparse_dot_avx512(const float* w, const IndexType* idx, const float* x,
+		size_t n, float* gathered){
+		__m512 acc = _mm512_setzero_ps();
+		for (size_t i = 0; i < n; i += 16){
+			__mmask16 mask = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+			__m512i vi = _mm512_maskz_loadu_epi32(mask, idx + i);
+			__m512 vw = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, vi, w, 4);
+			if (gathered != NULL){
+				_mm512_mask_storeu_ps(gathered + i, mask, vw);
+			}
+			acc = _mm512_fmadd_ps(vw, _mm512_maskz_loadu_ps(mask, x + i), acc);
+		}
+		return _mm512_reduce_add_ps(acc);
+	}
+
+	__attribute__((target("avx512f")))
+	inline void sparse_axpy_avx512(float a, const IndexType* idx, const float* x,
+		size_t n, const float* gathered, float* w){
+		__m512 va = _mm512_set1_ps(a);
+		for (size_t i = 0; i < n; i += 16){
+			__mmask16 mask = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+			__m512i vi = _mm512_maskz_loadu_epi32(mask, idx + i);
+			__m512 vw;
+			if (gathered != NULL){
+				vw = _mm512_maskz_loadu_ps(mask, gathered + i);
+			}
+			else{
+				vw = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, vi, w, 4);
+			}
+			vw = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(mask, x + i), vw);
+			_mm512_mask_i32scatter_ps(w, mask, vi, vw, 4);
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	inline float sparse_dot_strided_avx512(const float* w, size_t stride, const IndexType* idx,
+		const float* x, size_t n){
+		__m512 acc = _mm512_setzero_ps();
+		__m512i vs = _mm512_set1_epi64((long long)stride);
+		for (size_t i = 0; i < n; i += 16){
+			__mmask16 mask = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+			__m512i vi = _mm512_maskz_loadu_epi32(mask, idx + i);
+			__m512i lo = _mm512_mul_epu32(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(vi)), vs);
+			__m512i hi = _mm512_mul_epu32(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(vi, 1)), vs);
+			__m256 wlo = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), (__mmask8)mask, lo, w, 4);
+			__m256 whi = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), (__mmask8)(mask >> 8), hi, w, 4);
+			__m512 vw = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(wlo)),
+				_mm256_castps_pd(whi), 1));
+			acc = _mm512_fmadd_ps(vw, _mm512_maskz_loadu_ps(mask, x + i), acc);
+		}
+		return _mm512_reduce_add_ps(acc);
+	}
+#pragma endregion AVX-512 Kernels
+#endif
+
+#pragma region Kernel Selection
+	/**
+	 * @Synopsis select_sparse_kernel get the kernel by name
+	 *
+	 * @Param name auto, scalar, avx2 or avx512, auto for the fastest one
+	 * supported by the processor
+	 * @Param kernel the selected kernel
+	 *
+	 * @Returns false if the kernel is unknown or not supported by the processor
+	 */
+	inline bool select_sparse_kernel(const std::string& name, SparseKernel& kernel){
+		bool is_auto = name == "auto";
+#ifdef SOL_SIMD_X86
+		__builtin_cpu_init();
+		if ((is_auto || name == "avx512") && __builtin_cpu_supports("avx512f")){
+			kernel.name = "avx512";
+			kernel.dot = sparse_dot_avx512;
+			kernel.axpy = sparse_axpy_avx512;
+			kernel.dot_strided = sparse_dot_strided_avx512;
+			return true;
+		}
+		if ((is_auto || name == "avx2") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+			kernel.name = "avx2";
+			kernel.dot = sparse_dot_avx2;
+			kernel.axpy = sparse_axpy_avx2;
+			kernel.dot_strided = sparse_dot_strided_avx2;
+			return true;
+		}
+#endif
+		if (is_auto || name == "scalar"){
+			kernel.name = "scalar";
+			kernel.dot = sparse_dot_scalar;
+			kernel.axpy = sparse_axpy_scalar;
+			kernel.dot_strided = sparse_dot_strided_scalar;
+			return true;
+		}
+		return false;
+	}
+
+	//the kernel used by the models
+	inline SparseKernel& sparse_kernel(){
+		static SparseKernel kernel = { "scalar", sparse_dot_scalar, sparse_axpy_scalar,
+			sparse_dot_strided_scalar };
+		static bool is_selected = select_sparse_kernel("auto", kernel);
+		(void)is_selected;
+		return kernel;
+	}
+
+	/**
+	 * @Synopsis set_sparse_kernel change the kernel used by the models, should
+	 * be called before training
+	 *
+	 * @Returns false if the kernel is unknown or not supported by the processor
+	 */
+	inline bool set_sparse_kernel(const std::string& name){
+		return select_sparse_kernel(name, sparse_kernel());
+	}
+
+	//prefetch the weights of an example
+	inline void sparse_prefetch(const float* w, const IndexType* idx, size_t n){
+#ifdef __GNUC__
+		for (size_t i = 0; i < n; ++i){
+			__builtin_prefetch(w + idx[i]);
+		}
+#endif
+	}
+#pragma endregion Kernel Selection
+
+#pragma region Typed Wrappers
+	//features of other types than float are processed by the scalar loop,
+	//is_strict is the result of sparse_is_strict kept with the example
+	template <typename FeatType>
+	inline float sparse_dot(const float* w, const IndexType* idx, const FeatType* x,
+		size_t n, bool is_strict, float* gathered){
+		float sum = 0;
+		for (size_t i = 0; i < n; ++i){
+			float wi = w[idx[i]];
+			if (gathered != NULL){
+				gathered[i] = wi;
+			}
+			sum += wi * x[i];
+		}
+		return sum;
+	}
+
+	inline float sparse_dot(const float* w, const IndexType* idx, const float* x,
+		size_t n, bool is_strict, float* gathered){
+		if (is_strict == false){
+			return sparse_dot_scalar(w, idx, x, n, gathered);
+		}
+		return sparse_kernel().dot(w, idx, x, n, gathered);
+	}
+
+	template <typename FeatType>
+	inline void sparse_axpy(float a, const IndexType* idx, const FeatType* x,
+		size_t n, bool is_strict, const float* gathered, float* w){
+		//the gathered weights equal w[idx[i]], += also sums duplicated indexes
+		(void)is_strict;
+		(void)gathered;
+		for (size_t i = 0; i < n; ++i){
+			w[idx[i]] += a * x[i];
+		}
+	}
+
+	inline void sparse_axpy(float a, const IndexType* idx, const float* x,
+		size_t n, bool is_strict, const float* gathered, float* w){
+		if (is_strict == false){
+			sparse_axpy_scalar(a, idx, x, n, NULL, w);
+			return;
+		}
+		sparse_kernel().axpy(a, idx, x, n, gathered, w);
+	}
+
+	//the strided gather only reads the weights, so duplicated indexes are valid
+	template <typename FeatType>
+	inline float sparse_dot_strided(const float* w, size_t stride, const IndexType* idx,
+		const FeatType* x, size_t n){
+		float sum = 0;
+		for (size_t i = 0; i < n; ++i){
+			sum += w[idx[i] * stride] * x[i];
+		}
+		return sum;
+	}
+
+	inline float sparse_dot_strided(const float* w, size_t stride, const IndexType* idx,
+		const float* x, size_t n){
+		return sparse_kernel().dot_strided(w, stride, idx, x, n);
+	}
+#pragma endregion Typed Wrappers
+}
+
+#endif
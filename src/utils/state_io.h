@@ -0,0 +1,124 @@
+/*************************************************************************
+	> File Name: state_io.h
+	> Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+	> Created Time: 10/20/2026 4:05:12 PM
+	> Functions: raw binary serialization of the training states
+	************************************************************************/
+#ifndef HEADER_STATE_IO
+#define HEADER_STATE_IO
+
+#include "s_array.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace BOC {
+	/**
+	 * The states are written as they are in memory, they are only read back
+	 * by the same build to resume training, so there is no conversion.
+	 */
+	template <typename T>
+	inline void write_value(std::ostream &os, const T &val) {
+		os.write((const char*)&val, sizeof(T));
+	}
+
+	//length followed by the elements
+	template <typename T>
+	inline void write_array(std::ostream &os, const s_array<T> &arr) {
+		uint64_t len = arr.size();
+		write_value(os, len);
+		if (len > 0){
+			os.write((const char*)arr.begin, sizeof(T) * len);
+		}
+	}
+
+	template <typename T>
+	inline void write_array(std::ostream &os, const std::vector<s_array<T> > &arrs) {
+		for (size_t k = 0; k < arrs.size(); ++k){
+			write_array(os, arrs[k]);
+		}
+	}
+
+	inline void write_string(std::ostream &os, const std::string &str) {
+		uint64_t len = str.size();
+		write_value(os, len);
+		os.write(str.data(), len);
+	}
+
+	/**
+	 * reads the states from memory, like a mapped model file. Reading past
+	 * the end fails and leaves the value unchanged, the failure is kept so
+	 * that it is checked once after all the reads.
+	 */
+	class state_reader {
+	protected:
+		const char* p;
+		const char* end;
+		bool is_ok;
+
+	public:
+		state_reader(const char* data, size_t len) : p(data), end(data + len), is_ok(true) {
+		}
+
+		inline bool ok() const { return this->is_ok; }
+		inline bool empty() const { return this->p == this->end; }
+
+		template <typename T>
+		bool read_value(T &val) {
+			if (this->check(sizeof(T)) == false){
+				return false;
+			}
+			std::memcpy(&val, this->p, sizeof(T));
+			this->p += sizeof(T);
+			return true;
+		}
+
+		//the array is resized to the saved length
+		template <typename T>
+		bool read_array(s_array<T> &arr) {
+			uint64_t len = 0;
+			if (this->read_value(len) == false || this->check(sizeof(T) * len) == false){
+				return false;
+			}
+			arr.resize((size_t)len);
+			if (len > 0){
+				std::memcpy(arr.begin, this->p, sizeof(T) * len);
+			}
+			this->p += sizeof(T) * len;
+			return true;
+		}
+
+		template <typename T>
+		bool read_array(std::vector<s_array<T> > &arrs) {
+			for (size_t k = 0; k < arrs.size(); ++k){
+				if (this->read_array(arrs[k]) == false){
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool read_string(std::string &str) {
+			uint64_t len = 0;
+			if (this->read_value(len) == false || this->check(len) == false){
+				return false;
+			}
+			str.assign(this->p, (size_t)len);
+			this->p += len;
+			return true;
+		}
+
+	protected:
+		inline bool check(uint64_t len) {
+			if (this->is_ok == true && (uint64_t)(this->end - this->p) < len){
+				this->is_ok = false;
+			}
+			return this->is_ok;
+		}
+	};
+}
+
+#endif
@@ -8,14 +8,30 @@
 #ifndef HEADER_THREAD_PRIMITIVE
 #define HEADER_THREAD_PRIMITIVE
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#endif
+
 namespace BOC {
 #ifdef _WIN32
 #include <Windows.h>
 	typedef CRITICAL_SECTION MUTEX;
 	typedef CONDITION_VARIABLE CV;
+	typedef HANDLE THREAD;
 #else
 	typedef pthread_mutex_t MUTEX;
 	typedef pthread_cond_t CV;
+	typedef pthread_t THREAD;
 #endif
 
 #ifdef _WIN32
@@ -105,6 +121,162 @@ namespace BOC {
 #endif
 	}
 
+#ifdef _WIN32
+	inline void join_thread(HANDLE& thread){
+		::WaitForSingleObject(thread, INFINITE);
+		::CloseHandle(thread);
+	}
+#else
+	inline void join_thread(pthread_t& thread){
+		pthread_join(thread, NULL);
+	}
+#endif
+
+	//number of online processors
+	inline int get_cpu_num(){
+#ifdef _WIN32
+		SYSTEM_INFO sys_info;
+		::GetSystemInfo(&sys_info);
+		return (int)(sys_info.dwNumberOfProcessors);
+#else
+		long num = sysconf(_SC_NPROCESSORS_ONLN);
+		return num > 0 ? (int)num : 1;
+#endif
+	}
+
+	/**
+	 * @Synopsis bind_current_thread bind the calling thread to a processor
+	 *
+	 * @Param cpu index of the processor
+	 *
+	 * @Returns true if succeed
+	 */
+	inline bool bind_current_thread(int cpu){
+		if (cpu < 0){
+			return false;
+		}
+#if defined(_WIN32)
+		if (cpu >= (int)(sizeof(DWORD_PTR) * 8)){
+			return false;
+		}
+		return ::SetThreadAffinityMask(::GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+		if (cpu >= CPU_SETSIZE){
+			return false;
+		}
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		CPU_SET(cpu, &cpu_set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+		return false;
+#endif
+	}
+
+	//processor the calling thread is running on, -1 if unknown
+	inline int get_current_cpu(){
+#if defined(_WIN32)
+		return (int)(::GetCurrentProcessorNumber());
+#elif defined(__linux__)
+		return sched_getcpu();
+#else
+		return -1;
+#endif
+	}
+
+	//numa node of the processor, -1 if unknown
+	inline int get_cpu_node(int cpu){
+		if (cpu < 0){
+			return -1;
+		}
+#if defined(_WIN32)
+		UCHAR node = 0;
+		if (::GetNumaProcessorNode((UCHAR)cpu, &node) == 0 || node == 0xFF){
+			return -1;
+		}
+		return (int)node;
+#elif defined(__linux__)
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+		DIR* dir = opendir(path);
+		if (dir == NULL){
+			return -1;
+		}
+		int node = -1;
+		struct dirent* entry = NULL;
+		while ((entry = readdir(dir)) != NULL){
+			if (strncmp(entry->d_name, "node", 4) == 0 &&
+				entry->d_name[4] >= '0' && entry->d_name[4] <= '9'){
+				node = atoi(entry->d_name + 4);
+				break;
+			}
+		}
+		closedir(dir);
+		return node;
+#else
+		return -1;
+#endif
+	}
+
+	/**
+	 * @Synopsis bind_current_thread_to_node bind the calling thread to the
+	 * processors of a numa node, it can still move between them
+	 *
+	 * @Param node index of the numa node
+	 *
+	 * @Returns true if succeed
+	 */
+	inline bool bind_current_thread_to_node(int node){
+		if (node < 0){
+			return false;
+		}
+#if defined(_WIN32)
+		ULONGLONG node_mask = 0;
+		if (::GetNumaNodeProcessorMask((UCHAR)node, &node_mask) == 0 || node_mask == 0){
+			return false;
+		}
+		return ::SetThreadAffinityMask(::GetCurrentThread(), (DWORD_PTR)node_mask) != 0;
+#elif defined(__linux__)
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		int cpu_num = get_cpu_num();
+		bool is_found = false;
+		for (int cpu = 0; cpu < cpu_num && cpu < CPU_SETSIZE; ++cpu){
+			if (get_cpu_node(cpu) == node){
+				CPU_SET(cpu, &cpu_set);
+				is_found = true;
+			}
+		}
+		return is_found == true &&
+			pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @Synopsis set_preferred_node allocate the memory touched by the calling
+	 * thread on the numa node when possible
+	 *
+	 * @Param node index of the numa node
+	 *
+	 * @Returns true if succeed
+	 */
+	inline bool set_preferred_node(int node){
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+		const int mpol_preferred = 1;
+		const int max_node = (int)(sizeof(unsigned long) * 8);
+		if (node < 0 || node >= max_node){
+			return false;
+		}
+		unsigned long node_mask = 1UL << node;
+		return syscall(SYS_set_mempolicy, mpol_preferred, &node_mask, (unsigned long)max_node + 1) == 0;
+#else
+		//windows allocates on the node of the first touching thread
+		return false;
+#endif
+	}
+
 	/*
 	#ifdef _WIN32
 	void WaitThread(HANDLE &thread){
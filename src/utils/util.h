@@ -26,6 +26,7 @@
 #endif
 
 #include <cstdlib>
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 
@@ -180,6 +181,22 @@ inline double get_current_time(){
 #endif
 }
 
+//resident memory of the process in bytes, 0 if not known
+inline size_t get_rss_bytes(){
+#if defined(__linux__)
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == NULL){
+		return 0;
+	}
+	unsigned long size = 0, resident = 0;
+	int ret = fscanf(file, "%lu %lu", &size, &resident);
+	fclose(file);
+	return ret == 2 ? (size_t)resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+	return 0;
+#endif
+}
+
 template <typename T1, typename T2>
 void QuickSort(T1 *a, T2 *b, size_t low, size_t high){ // from small to great
 	size_t i = low;
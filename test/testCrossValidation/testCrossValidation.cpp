@@ -0,0 +1,123 @@
+/*************************************************************************
+  > File Name: testCrossValidation.cpp
+  > Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+  > Created Time: 10/21/2026 10:14:37 AM
+  > Functions: Test the held-out errors of cross validation for the models
+  > keeping their weights in the per-feature states
+ ************************************************************************/
+#include "BOC.h"
+#include "utils/init_param.h"
+
+#include <cstdio>
+#include <cmath>
+#include <string>
+
+using namespace std;
+using namespace BOC;
+
+static const char* data_file = "cv_test_data.txt";
+//held-out error rate above which a model is taken as not learning
+static const float max_heldout_error = 0.3f;
+
+//xorshift random numbers in [0, 1)
+static unsigned int rand_state = 2463534242u;
+float rand_uniform(){
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return (rand_state >> 8) / 16777216.f;
+}
+
+/**
+ * WriteData : noisy linear data with sparse features in the libsvm format
+ */
+bool WriteData(){
+	const int num = 6000;
+	const int dim = 200;
+	const int feat_num = 20;
+	float w_true[dim + 1];
+	for (int i = 1; i <= dim; ++i){
+		w_true[i] = rand_uniform() - 0.5f;
+	}
+	FILE* file = fopen(data_file, "w");
+	if (file == NULL){
+		printf("open %s failed\n", data_file);
+		return false;
+	}
+	for (int t = 0; t < num; ++t){
+		int indexes[feat_num];
+		float features[feat_num];
+		float score = 0;
+		//strictly increasing indexes
+		int index = 0;
+		for (int i = 0; i < feat_num; ++i){
+			index += 1 + (int)(rand_uniform() * (dim / feat_num - 1));
+			indexes[i] = index;
+			features[i] = rand_uniform() * 2 - 1;
+			score += w_true[index] * features[i];
+		}
+		fprintf(file, "%d", score + (rand_uniform() - 0.5f) * 0.2f > 0 ? 1 : -1);
+		for (int i = 0; i < feat_num; ++i){
+			fprintf(file, " %d:%g", indexes[i], features[i]);
+		}
+		fprintf(file, "\n");
+	}
+	fclose(file);
+	return true;
+}
+
+//exposes the optimizer to get the result of cross validation
+class CrossValidator : public LibBOC<float, char> {
+public:
+	float Train(){
+		if (this->pDataset->Load(this->pParam->StringValue("-i"), this->pParam->StringValue("-c"),
+			this->pParam->StringValue("-df")) == false){
+			return -1;
+		}
+		return this->pOpti->Train();
+	}
+};
+
+/**
+ * CrossValidate : run k-fold cross validation of a model
+ *
+ * @Returns mean held-out error rate, -1 if failed
+ */
+float CrossValidate(const char* model){
+	const char* args[] = { "SOL", "-i", data_file, "-m", model, "-cv", "3", "-l1", "0" };
+	Params param;
+	CrossValidator validator;
+	validator.InitParams(param);
+	if (param.Parse(sizeof(args) / sizeof(args[0]), args) == false ||
+		validator.Initialize(param) != STATUS_OK){
+		return -1;
+	}
+	return validator.Train();
+}
+
+int main(int argc, const char** args){
+	if (WriteData() == false){
+		return 1;
+	}
+	//STG and FOBOS are SGD without l1 regularization
+	const char* models[] = { "SGD", "STG", "FOBOS", "Ada_RDA", "CW_RDA" };
+	const int model_num = sizeof(models) / sizeof(models[0]);
+	float errors[model_num];
+	for (int i = 0; i < model_num; ++i){
+		errors[i] = CrossValidate(models[i]);
+	}
+	bool is_ok = true;
+	for (int i = 0; i < model_num; ++i){
+		printf("%s: held-out error rate %.2f %%\n", models[i], errors[i] * 100);
+		if (errors[i] < 0 || errors[i] > max_heldout_error){
+			is_ok = false;
+		}
+	}
+	if (errors[1] != errors[0] || errors[2] != errors[0]){
+		printf("STG and FOBOS are different from SGD\n");
+		is_ok = false;
+	}
+	remove(data_file);
+	printf("%s\n", is_ok ? "passed" : "failed");
+	return is_ok ? 0 : 1;
+}
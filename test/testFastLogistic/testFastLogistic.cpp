@@ -0,0 +1,170 @@
+/*************************************************************************
+  > File Name: testFastLogistic.cpp
+  > Copyright (C) 2013 Yue Wu<yuewu@outlook.com>
+  > Created Time: 10/20/2026 7:02:15 PM
+  > Functions: Test the accuracy of the approximate logistic loss
+ ************************************************************************/
+
+//the loss headers expect these to be declared
+#include <cmath>
+#include <string>
+using namespace std;
+
+#include "loss/LogisticLoss.h"
+#include "loss/FastLogisticLoss.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace BOC;
+
+typedef LogisticLoss<float, char> ExactLoss;
+typedef FastLogisticLoss<float, char> FastLoss;
+
+//maximum errors of the approximations, see FastLogisticLoss.h
+static const double max_exp_error = 3e-7;
+static const double max_loss_error = 1.5e-7;
+static const double max_gradient_error = 5e-7;
+//maximum difference of the error rates of the trained models
+static const double max_error_rate_diff = 0.001;
+
+//xorshift random numbers in [0, 1)
+static unsigned int rand_state = 2463534242u;
+float rand_uniform(){
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return (rand_state >> 8) / 16777216.f;
+}
+
+/**
+ * TestFunctions : the errors of exp, the loss and the gradient against the
+ * exact values in double precision, on the float inputs
+ */
+bool TestFunctions(){
+	double exp_error = 0;
+	for (double x = -87; x <= 88; x += 1e-4){
+		float xf = (float)x;
+		double val = exp((double)xf);
+		exp_error = max(exp_error, fabs(fast_exp(xf) - val) / val);
+	}
+
+	double loss_error = 0;
+	double gradient_error = 0;
+	FastLoss fast_loss;
+	for (double m = -100; m <= 100; m += 1e-4){
+		float mf = (float)m;
+		for (char label = -1; label <= 1; label += 2){
+			float loss = 0;
+			fast_loss.GetLoss(label, &mf, &loss, 1);
+			double t = -(double)mf * label;
+			double val = t > 0 ? t + log1p(exp(-t)) : log1p(exp(t));
+			loss_error = max(loss_error, fabs(loss - val) / max(val, 1.0));
+
+			//the gradient is -label * sigmoid(-label * m), relative to its
+			//magnitude, which is tiny beyond the clamped range of exp
+			double grad = -label / (1 + exp(-t));
+			double error = fabs(FastLoss::Gradient(label, mf) - grad);
+			gradient_error = max(gradient_error, error / max(fabs(grad), 1e-30));
+		}
+	}
+	printf("max relative error of exp: %g\n", exp_error);
+	printf("max error of the loss: %g\n", loss_error);
+	printf("max relative error of the gradient: %g\n", gradient_error);
+	return exp_error < max_exp_error && loss_error < max_loss_error &&
+		gradient_error < max_gradient_error;
+}
+
+/**
+ * TestGradients : the batched gradients equal the ones of each example
+ */
+bool TestGradients(){
+	const size_t num = 1000;
+	vector<char> labels(num);
+	vector<float> predicts(num);
+	vector<float> gradients(num);
+	for (size_t i = 0; i < num; ++i){
+		labels[i] = rand_uniform() < 0.5f ? -1 : 1;
+		predicts[i] = (rand_uniform() - 0.5f) * 200;
+	}
+	FastLoss fast_loss;
+	fast_loss.GetGradients(&labels[0], &predicts[0], &gradients[0], num);
+	for (size_t i = 0; i < num; ++i){
+		if (gradients[i] != FastLoss::Gradient(labels[i], predicts[i])){
+			printf("batched gradient %lu is different\n", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Train : online gradient descent of logistic regression on dense examples
+ *
+ * @Returns error rate of the predictions before the updates
+ */
+template <typename LossType>
+float Train(const vector<vector<float> > &data, const vector<char> &labels, vector<float> &w){
+	size_t dim = data[0].size();
+	w.assign(dim, 0);
+	size_t error_num = 0;
+	for (size_t t = 0; t < data.size(); ++t){
+		const vector<float> &x = data[t];
+		float predict = 0;
+		for (size_t i = 0; i < dim; ++i){
+			predict += w[i] * x[i];
+		}
+		if (LossFunction<float, char>::Sign(predict) != labels[t]){
+			error_num++;
+		}
+		float eta = 1.f / sqrtf((float)(t + 1));
+		float gt = LossType::Gradient(labels[t], predict);
+		for (size_t i = 0; i < dim; ++i){
+			w[i] -= eta * gt * x[i];
+		}
+	}
+	return error_num / (float)data.size();
+}
+
+/**
+ * TestTraining : the models trained with the exact and the approximate
+ * losses on noisy linear data
+ */
+bool TestTraining(){
+	const size_t num = 200000;
+	const size_t dim = 32;
+	vector<float> w_true(dim);
+	for (size_t i = 0; i < dim; ++i){
+		w_true[i] = rand_uniform() - 0.5f;
+	}
+	vector<vector<float> > data(num, vector<float>(dim));
+	vector<char> labels(num);
+	for (size_t t = 0; t < num; ++t){
+		float score = 0;
+		for (size_t i = 0; i < dim; ++i){
+			data[t][i] = rand_uniform() * 2 - 1;
+			score += w_true[i] * data[t][i];
+		}
+		labels[t] = score + (rand_uniform() - 0.5f) * 0.5f > 0 ? 1 : -1;
+	}
+
+	vector<float> w_exact, w_fast;
+	float exact_rate = Train<ExactLoss>(data, labels, w_exact);
+	float fast_rate = Train<FastLoss>(data, labels, w_fast);
+	double w_diff = 0, w_norm = 0;
+	for (size_t i = 0; i < dim; ++i){
+		w_diff += (w_exact[i] - w_fast[i]) * (w_exact[i] - w_fast[i]);
+		w_norm += w_exact[i] * w_exact[i];
+	}
+	printf("error rate: %.4f %% (Logistic) %.4f %% (FastLogistic)\n", exact_rate * 100, fast_rate * 100);
+	printf("relative difference of the weights: %g\n", sqrt(w_diff / w_norm));
+	return fabs(exact_rate - fast_rate) < max_error_rate_diff;
+}
+
+int main(int argc, const char** args){
+	bool is_ok = TestFunctions();
+	is_ok = TestGradients() && is_ok;
+	is_ok = TestTraining() && is_ok;
+	printf("%s\n", is_ok ? "passed" : "failed");
+	return is_ok ? 0 : 1;
+}